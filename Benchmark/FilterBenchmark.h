@@ -0,0 +1,185 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../ConeOrientation/CalibrationVideos.h"
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/ConeFilter.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelineContext.h"
+#include "../DetectionCore/RegionOfInterest.h"
+#include "../DetectionCore/Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+const int MAX_FILTER_LAG_FRAMES = 15;
+
+/**
+ * \brief The cone of every frame of a video, with a flag for the frames it was found in.
+ */
+struct ConeSeries {
+
+	vector<ConeDetails> Details;
+	vector<bool> Found;
+	double FrameRate = 0;
+	double RoiHitRate = 0;
+};
+
+/**
+ * \brief Runs a video through the tracked pipeline, filtered if TemporalFilter is set, with the frames timed by the frame rate of the video.
+ */
+inline bool RunConeSeries(const string& path, const Parameters& parameters, PipelineContext& context, ConeSeries& series) {
+
+	VideoCapture videoCapture(path);
+
+	if (!videoCapture.isOpened()) {
+		return false;
+	}
+
+	series.FrameRate = videoCapture.get(CAP_PROP_FPS) > 0 ? videoCapture.get(CAP_PROP_FPS) : 30;
+
+	RegionTracker tracker = RegionTracker();
+	ConeFilter filter = ConeFilter();
+	Mat frame;
+
+	while (videoCapture.read(frame) && !frame.empty()) {
+
+		ConeDetails measurement{}, coneDetails{};
+		const double time = series.Details.size() / series.FrameRate;
+
+		series.Found.push_back(DetectConeFiltered(frame, time, parameters, context, tracker, filter, &measurement, &coneDetails));
+		series.Details.push_back(coneDetails);
+	}
+
+	series.RoiHitRate = tracker.GetHitRate();
+	return true;
+}
+
+/**
+ * \brief The root mean square of the second difference of x, y and the angle in degrees over every 3 consecutive frames the cone was found
+ *  in. The cones in the videos move smoothly, so this is mostly the frame to frame noise.
+ */
+inline Point3d Jitter(const ConeSeries& series) {
+
+	double sumX = 0, sumY = 0, sumAngle = 0;
+	int count = 0;
+
+	for (size_t i = 2; i < series.Details.size(); i++) {
+
+		if (!series.Found[i] || !series.Found[i - 1] || !series.Found[i - 2]) {
+			continue;
+		}
+
+		const Point2d position = series.Details[i].GetCentroidPosition() - 2 * series.Details[i - 1].GetCentroidPosition() +
+			series.Details[i - 2].GetCentroidPosition();
+		const double angle = remainder(series.Details[i].GetAngle() - series.Details[i - 1].GetAngle(), 2 * PI) -
+			remainder(series.Details[i - 1].GetAngle() - series.Details[i - 2].GetAngle(), 2 * PI);
+
+		sumX += position.x * position.x;
+		sumY += position.y * position.y;
+		sumAngle += angle * angle;
+		count++;
+	}
+
+	if (count == 0) {
+		return Point3d(0, 0, 0);
+	}
+
+	return Point3d(sqrt(sumX / count), sqrt(sumY / count), sqrt(sumAngle / count) * 180 / PI);
+}
+
+/**
+ * \brief The number of frames the filtered positions trail the unfiltered ones by, which is the shift that brings them closest together. It
+ *  is negative when predicting ahead more than makes up for the smoothing.
+ */
+inline int LagFrames(const ConeSeries& unfiltered, const ConeSeries& filtered) {
+
+	const int frameCount = (int)min(unfiltered.Details.size(), filtered.Details.size());
+
+	int bestLag = 0;
+	double bestError = -1;
+
+	for (int lag = -MAX_FILTER_LAG_FRAMES; lag <= MAX_FILTER_LAG_FRAMES; lag++) {
+
+		double error = 0;
+		int count = 0;
+
+		for (int i = max(lag, 0); i < frameCount && i - lag < frameCount; i++) {
+
+			if (!filtered.Found[i] || !unfiltered.Found[i - lag]) {
+				continue;
+			}
+
+			const Point2d difference = filtered.Details[i].GetCentroidPosition() - unfiltered.Details[i - lag].GetCentroidPosition();
+			error += difference.dot(difference);
+			count++;
+		}
+
+		if (count > 0 && (bestError < 0 || error / count < bestError)) {
+			bestError = error / count;
+			bestLag = lag;
+		}
+	}
+
+	return bestLag;
+}
+
+inline void PrintFilterRow(const string& name, const Point3d jitter, const double lagMilliseconds, const double roiHitRate) {
+
+	cout << "  " << left << setw(12) << name << right << fixed << setprecision(3) << setw(10) << jitter.x << setw(10) << jitter.y
+		<< setw(10) << jitter.z << setw(10) << setprecision(1) << lagMilliseconds << setw(10) << roiHitRate * 100 << "%" << endl;
+}
+
+/**
+ * \brief Runs every calibration video with region tracking, once unfiltered and once with the temporal filter and the search region moved
+ *  along with the predicted motion, and prints the jitter of the published cone, how far the filtered cone trails the unfiltered one and
+ *  the hit rate of the search region.
+ */
+inline int RunFilterBenchmark(const string& videoDirectory, const Parameters& parameters) {
+
+	Parameters unfilteredParameters = parameters;
+	unfilteredParameters.RoiTracking = 1;
+	unfilteredParameters.TemporalFilter = 0;
+
+	Parameters filteredParameters = unfilteredParameters;
+	filteredParameters.TemporalFilter = 1;
+
+	const PipelineTables tables(parameters);
+	PipelineContext context = PipelineContext(parameters.CameraResolution, tables);
+
+	cout << "alpha " << parameters.FilterAlpha << "%, beta " << parameters.FilterBeta << "%, predicted " << parameters.PredictionLatency
+		<< " ms ahead" << endl;
+
+	for (const string& video : CALIBRATION_VIDEOS) {
+
+		ConeSeries unfiltered, filtered;
+
+		if (!RunConeSeries(CalibrationVideoPath(videoDirectory, video), unfilteredParameters, context, unfiltered) ||
+			!RunConeSeries(CalibrationVideoPath(videoDirectory, video), filteredParameters, context, filtered)) {
+
+			cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+			return 1;
+		}
+
+		cout << video << " (" << unfiltered.Details.size() << " frames at " << fixed << setprecision(1) << unfiltered.FrameRate << " fps)" << endl;
+		cout << "  cone        x jitter  y jitter  a jitter   lag ms    ROI hits" << endl;
+
+		PrintFilterRow("unfiltered", Jitter(unfiltered), 0, unfiltered.RoiHitRate);
+		PrintFilterRow("filtered", Jitter(filtered), LagFrames(unfiltered, filtered) * 1000 / filtered.FrameRate, filtered.RoiHitRate);
+
+		cout << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
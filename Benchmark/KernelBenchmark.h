@@ -0,0 +1,268 @@
+﻿#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../ConeOrientation/CalibrationVideos.h"
+#include "../DetectionCore/BatchGeometry.h"
+#include "../DetectionCore/ContourKernels.h"
+#include "../DetectionCore/Detection.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelineContext.h"
+#include "../DetectionCore/Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief A cone contour found in the calibration videos and the input of each contour kernel for it.
+ */
+struct KernelInput {
+
+	vector<Point2i> Contour;
+	Point2i Centroid;
+	int CornerThreshold = 0;
+};
+
+/**
+ * \brief Runs the pipeline over the calibration videos and keeps every cone contour it finds.
+ */
+inline bool CollectKernelInputs(const string& videoDirectory, const Parameters& parameters, PipelineContext& context,
+	vector<KernelInput>& inputs) {
+
+	for (const string& video : CALIBRATION_VIDEOS) {
+
+		VideoCapture videoCapture(CalibrationVideoPath(videoDirectory, video));
+
+		if (!videoCapture.isOpened()) {
+			cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+			return false;
+		}
+
+		Mat frame;
+
+		while (videoCapture.read(frame) && !frame.empty()) {
+
+			PreProcessImage(frame, parameters, context);
+
+			if (FindConeContour(parameters, context).empty()) {
+				continue;
+			}
+
+			KernelInput input;
+			input.Contour = context.ConeContour;
+			input.Centroid = context.ConeStats.GetCentroid();
+
+			const int farthestIndex = FarthestPointIndex(input.Contour, input.Centroid, context.SquaredDistances);
+			input.CornerThreshold = CornerSquaredDistanceThreshold(context.SquaredDistances[farthestIndex]);
+
+			inputs.push_back(move(input));
+		}
+	}
+
+	return true;
+}
+
+/**
+ * \brief Times the scalar and the vectorized farthest point and radial filter kernels on the cone contours of the calibration videos,
+ *  checks that both give the same results and prints the time per contour point.
+ */
+inline int RunKernelBenchmark(const string& videoDirectory, const int iterations, const Parameters& parameters) {
+
+	const PipelineTables tables(parameters);
+	PipelineContext context = PipelineContext(parameters.CameraResolution, tables);
+	vector<KernelInput> inputs;
+
+	if (!CollectKernelInputs(videoDirectory, parameters, context, inputs)) {
+		return 1;
+	}
+
+	long long pointCount = 0;
+	size_t largestContour = 1;
+
+	for (const KernelInput& input : inputs) {
+		pointCount += input.Contour.size();
+		largestContour = max(largestContour, input.Contour.size());
+	}
+
+	if (pointCount == 0) {
+		cerr << "No cone was found in the calibration videos" << endl;
+		return 1;
+	}
+
+	// enough repetitions for the kernels to run for a measurable time
+	const int repetitions = iterations * 20;
+
+	vector<int> squaredDistances(largestContour), simdSquaredDistances(largestContour);
+	vector<int> indices(largestContour), simdIndices(largestContour);
+
+	double farthestScalarTime = 0, farthestSimdTime = 0, radialScalarTime = 0, radialSimdTime = 0;
+	int mismatches = 0;
+
+	for (const KernelInput& input : inputs) {
+
+		const Point2i* points = input.Contour.data();
+		const int count = (int)input.Contour.size();
+
+		time_point<steady_clock> startTime = steady_clock::now();
+		int farthestIndex = 0;
+
+		for (int i = 0; i < repetitions; i++) {
+			farthestIndex = FarthestPointIndexScalar(points, count, input.Centroid, squaredDistances.data());
+		}
+
+		farthestScalarTime += duration<double, nano>(steady_clock::now() - startTime).count();
+		startTime = steady_clock::now();
+		int simdFarthestIndex = 0;
+
+		for (int i = 0; i < repetitions; i++) {
+			simdFarthestIndex = FarthestPointIndexSimd(points, count, input.Centroid, simdSquaredDistances.data());
+		}
+
+		farthestSimdTime += duration<double, nano>(steady_clock::now() - startTime).count();
+		startTime = steady_clock::now();
+		int found = 0;
+
+		for (int i = 0; i < repetitions; i++) {
+			found = RadialFilterScalar(squaredDistances.data(), count, input.CornerThreshold, indices.data());
+		}
+
+		radialScalarTime += duration<double, nano>(steady_clock::now() - startTime).count();
+		startTime = steady_clock::now();
+		int simdFound = 0;
+
+		for (int i = 0; i < repetitions; i++) {
+			simdFound = RadialFilterSimd(squaredDistances.data(), count, input.CornerThreshold, simdIndices.data());
+		}
+
+		radialSimdTime += duration<double, nano>(steady_clock::now() - startTime).count();
+
+		const bool same = farthestIndex == simdFarthestIndex && found == simdFound &&
+			equal(squaredDistances.begin(), squaredDistances.begin() + count, simdSquaredDistances.begin()) &&
+			equal(indices.begin(), indices.begin() + found, simdIndices.begin());
+
+		if (!same) {
+			mismatches++;
+		}
+	}
+
+	const double pointRuns = (double)pointCount * repetitions;
+
+	cout << inputs.size() << " cone contours, " << pointCount / inputs.size() << " points on average, "
+		<< (CV_SIMD ? "vectorized" : "no SIMD, both use the scalar code") << endl;
+	cout << "  kernel          scalar ns/pt   simd ns/pt   speedup" << endl;
+
+	cout << "  " << left << setw(16) << "farthest point" << right << fixed << setprecision(3)
+		<< setw(12) << farthestScalarTime / pointRuns << setw(13) << farthestSimdTime / pointRuns
+		<< setw(9) << setprecision(2) << farthestScalarTime / max(farthestSimdTime, 1e-9) << "x" << endl;
+
+	cout << "  " << left << setw(16) << "radial filter" << right << fixed << setprecision(3)
+		<< setw(12) << radialScalarTime / pointRuns << setw(13) << radialSimdTime / pointRuns
+		<< setw(9) << setprecision(2) << radialScalarTime / max(radialSimdTime, 1e-9) << "x" << endl;
+
+	if (mismatches > 0) {
+		cout << mismatches << " contours gave different results with the vectorized kernels" << endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * \brief The largest distance between the displacements of the batch projection and the scalar ones.
+ */
+template <typename T>
+inline double LargestDisplacementDifference(const vector<Point_<T>>& displacements, const vector<Point2d>& reference) {
+
+	double largestDifference = 0;
+
+	for (size_t i = 0; i < reference.size(); i++) {
+		largestDifference = max(largestDifference, norm(Point2d(displacements[i].x, displacements[i].y) - reference[i]));
+	}
+
+	return largestDifference;
+}
+
+/**
+ * \brief Times CalculateObjectDisplacement against the double and single precision batch projection of every point of the cone contours of
+ *  the calibration videos, and prints the time per point and the largest difference to the scalar results.
+ */
+inline int RunGeometryBenchmark(const string& videoDirectory, const int iterations, const Parameters& parameters) {
+
+	const PipelineTables tables(parameters);
+	PipelineContext context = PipelineContext(parameters.CameraResolution, tables);
+	vector<KernelInput> inputs;
+
+	if (!CollectKernelInputs(videoDirectory, parameters, context, inputs)) {
+		return 1;
+	}
+
+	vector<Point2i> points;
+
+	for (const KernelInput& input : inputs) {
+		points.insert(points.end(), input.Contour.begin(), input.Contour.end());
+	}
+
+	if (points.empty()) {
+		cerr << "No cone was found in the calibration videos" << endl;
+		return 1;
+	}
+
+	const GroundProjection<double> doubleProjection(parameters.CameraResolution, parameters.CameraFov, parameters.CameraOffset,
+		parameters.CameraAngle);
+	const GroundProjection<float> floatProjection(parameters.CameraResolution, parameters.CameraFov, parameters.CameraOffset,
+		parameters.CameraAngle);
+
+	vector<Point2d> scalarDisplacements(points.size()), doubleDisplacements;
+	vector<Point2f> floatDisplacements;
+
+	time_point<steady_clock> startTime = steady_clock::now();
+
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		for (size_t i = 0; i < points.size(); i++) {
+			scalarDisplacements[i] = CalculateObjectDisplacement(points[i], parameters.CameraResolution, parameters.CameraFov,
+				parameters.CameraOffset, parameters.CameraAngle);
+		}
+	}
+
+	const double scalarTime = duration<double, nano>(steady_clock::now() - startTime).count();
+	startTime = steady_clock::now();
+
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		doubleProjection.Project(points, doubleDisplacements);
+	}
+
+	const double doubleTime = duration<double, nano>(steady_clock::now() - startTime).count();
+	startTime = steady_clock::now();
+
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		floatProjection.Project(points, floatDisplacements);
+	}
+
+	const double floatTime = duration<double, nano>(steady_clock::now() - startTime).count();
+	const double pointRuns = (double)points.size() * iterations;
+
+	cout << points.size() << " cone contour points" << endl;
+	cout << "  projection      ns/pt     speedup   largest difference" << endl;
+
+	cout << "  " << left << setw(14) << "scalar" << right << fixed << setprecision(3) << setw(9) << scalarTime / pointRuns << endl;
+
+	cout << "  " << left << setw(14) << "batch double" << right << fixed << setprecision(3) << setw(9) << doubleTime / pointRuns
+		<< setw(11) << setprecision(2) << scalarTime / max(doubleTime, 1e-9) << "x" << setw(20) << scientific << setprecision(2)
+		<< LargestDisplacementDifference(doubleDisplacements, scalarDisplacements) << endl;
+
+	cout << "  " << left << setw(14) << "batch float" << right << fixed << setprecision(3) << setw(9) << floatTime / pointRuns
+		<< setw(11) << setprecision(2) << scalarTime / max(floatTime, 1e-9) << "x" << setw(20) << scientific << setprecision(2)
+		<< LargestDisplacementDifference(floatDisplacements, scalarDisplacements) << defaultfloat << endl;
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+
+/**
+ * \brief Collects latency samples in milliseconds and summarizes them.
+ */
+class LatencyStats {
+
+		vector<double> Samples;
+		bool Sorted = true;
+
+		void Sort() {
+
+			if (!Sorted) {
+				sort(Samples.begin(), Samples.end());
+				Sorted = true;
+			}
+		}
+
+	public:
+
+		void Add(const double milliseconds) {
+			Samples.push_back(milliseconds);
+			Sorted = false;
+		}
+
+		void Add(const LatencyStats& other) {
+			Samples.insert(Samples.end(), other.Samples.begin(), other.Samples.end());
+			Sorted = false;
+		}
+
+		size_t GetCount() const {
+			return Samples.size();
+		}
+
+		/**
+		 * \brief The nearest rank percentile of the samples.
+		 * \param percentile Between 0 and 100.
+		 */
+		double GetPercentile(const double percentile) {
+
+			if (Samples.empty()) {
+				return 0;
+			}
+
+			Sort();
+
+			const size_t rank = (size_t)ceil(percentile / 100.0 * Samples.size());
+			return Samples[rank == 0 ? 0 : min(rank, Samples.size()) - 1];
+		}
+
+		double GetMax() {
+			return GetPercentile(100);
+		}
+
+		double GetMean() const {
+
+			if (Samples.empty()) {
+				return 0;
+			}
+
+			double sum = 0;
+
+			for (const double sample : Samples) {
+				sum += sample;
+			}
+
+			return sum / Samples.size();
+		}
+
+		/**
+		 * \brief The number of samples that fit in one second at the mean latency.
+		 */
+		double GetFps() const {
+
+			const double mean = GetMean();
+			return mean > 0 ? 1000.0 / mean : 0;
+		}
+
+};
\ No newline at end of file
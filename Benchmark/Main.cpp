@@ -0,0 +1,354 @@
+// Replays the calibration videos through the detection pipeline without any UI and reports the latency of every stage.
+//
+// usage: Benchmark [--iterations N] [--videos DIRECTORY] [--mask-mode MODE] [--contours METHOD] [--pyramid LEVELS] [--multi] [--roi]
+//                  [--json FILE]
+//        Benchmark --kernels|--geometry [--iterations N] [--videos DIRECTORY]
+//        Benchmark --filter [--alpha PERCENT] [--beta PERCENT] [--predict MILLISECONDS] [--videos DIRECTORY]
+//
+// The frames run through the same ConeDetector as the robot, so every stage is timed in every search mode, as the sum of its runs within
+// the frame. --multi detects every cone instead of only the most central one. With --roi every video is also run with region of interest
+// tracking, which reports its hit rate and speedup. With --kernels only the scalar and vectorized contour kernels are compared, on the
+// cone contours of the videos, and with --geometry the scalar and batch ground projection of every point of those contours. With --filter
+// every video is run with region tracking, unfiltered and with the temporal filter, which reports the jitter of the cone, the lag of the
+// filter and the region hit rate with and without predicting the motion of the cone.
+//
+// Run it from the solution directory, or pass --videos. Outside of Visual Studio it builds with
+// g++ -O2 -std=c++14 Benchmark/Main.cpp -o benchmark $(pkg-config --cflags --libs opencv4)
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../ConeOrientation/CalibrationVideos.h"
+#include "../DetectionCore/ConeDetector.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelinePolicies.h"
+
+#include "FilterBenchmark.h"
+#include "KernelBenchmark.h"
+#include "LatencyStats.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+// the stages of the pipeline in the order of PIPELINE_STAGE_NAMES, then the whole frame
+const int STAGE_COUNT = PIPELINE_STAGE_COUNT + 1;
+const string STAGE_NAMES[STAGE_COUNT] = { "coarse", "preprocess", "contour", "details", "total" };
+const int TOTAL_STAGE = STAGE_COUNT - 1;
+
+struct VideoResult {
+
+	string Name;
+	int FrameCount = 0;
+	int ConeFrameCount = 0;
+	LatencyStats Stages[STAGE_COUNT];
+
+	double RoiHitRate = 0;
+	long long RoiFrameCount = 0;
+};
+
+/**
+ * \brief Runs every frame through the detector and times each stage, skipping the stages that did not run. Every iteration has a detector
+ *  of its own, so the region tracking and the filter see each frame once per iteration, like on the robot. The frames are timed by the
+ *  frame rate of the video.
+ */
+bool BenchmarkVideo(const string& path, const int iterations, const Parameters& parameters, VideoResult& result) {
+
+	VideoCapture videoCapture(path);
+
+	if (!videoCapture.isOpened()) {
+		return false;
+	}
+
+	const double frameRate = videoCapture.get(CAP_PROP_FPS) > 0 ? videoCapture.get(CAP_PROP_FPS) : 30;
+	vector<unique_ptr<BasicConeDetector<Timing>>> detectors;
+
+	for (int i = 0; i < iterations; i++) {
+		detectors.push_back(make_unique<BasicConeDetector<Timing>>(parameters));
+	}
+
+	Mat frame;
+	bool warmedUp = false;
+
+	while (videoCapture.read(frame) && !frame.empty()) {
+
+		// the first pass lets OpenCV allocate its internal buffers, which is not part of the per frame cost
+		if (!warmedUp) {
+			ConeDetector warmUpDetector(parameters);
+			warmUpDetector.Process(frame);
+			warmedUp = true;
+		}
+
+		const time_point<steady_clock> frameTime = time_point<steady_clock>(duration_cast<steady_clock::duration>(
+			duration<double>(result.FrameCount / frameRate)));
+
+		bool coneFound = false;
+
+		for (const unique_ptr<BasicConeDetector<Timing>>& detector : detectors) {
+
+			coneFound = detector->Process(frame, frameTime).ConeFound;
+			const Timing& timing = detector->GetDebug();
+
+			for (int stage = 0; stage < PIPELINE_STAGE_COUNT; stage++) {
+
+				if (timing.GetStageRunCount(stage) > 0) {
+					result.Stages[stage].Add(timing.GetStageMilliseconds(stage));
+				}
+			}
+
+			result.Stages[TOTAL_STAGE].Add(timing.GetFrameMilliseconds());
+		}
+
+		result.FrameCount++;
+
+		if (coneFound) {
+			result.ConeFrameCount++;
+		}
+	}
+
+	result.RoiHitRate = detectors[0]->GetRegionTracker().GetHitRate();
+	result.RoiFrameCount = detectors[0]->GetRegionTracker().GetRegionFrameCount();
+	return true;
+}
+
+void PrintTable(const string& title, const int frameCount, const int coneFrameCount, LatencyStats stages[STAGE_COUNT]) {
+
+	cout << title << " (" << frameCount << " frames, cone found in " << coneFrameCount << ")" << endl;
+	cout << "  stage           p50       p95       p99       max       fps" << endl;
+
+	for (int i = 0; i < STAGE_COUNT; i++) {
+
+		if (stages[i].GetCount() == 0) {
+			continue;
+		}
+
+		cout << "  " << left << setw(10) << STAGE_NAMES[i] << right << fixed << setprecision(3)
+			<< setw(10) << stages[i].GetPercentile(50)
+			<< setw(10) << stages[i].GetPercentile(95)
+			<< setw(10) << stages[i].GetPercentile(99)
+			<< setw(10) << stages[i].GetMax()
+			<< setw(10) << setprecision(1) << stages[i].GetFps() << endl;
+	}
+
+	cout << endl;
+}
+
+string StagesJson(LatencyStats stages[STAGE_COUNT]) {
+
+	stringstream json;
+	json << fixed << setprecision(4) << "{";
+
+	bool first = true;
+
+	for (int i = 0; i < STAGE_COUNT; i++) {
+
+		if (stages[i].GetCount() == 0) {
+			continue;
+		}
+
+		json << (first ? "" : ", ") << "\"" << STAGE_NAMES[i] << "\": {"
+			<< "\"p50\": " << stages[i].GetPercentile(50)
+			<< ", \"p95\": " << stages[i].GetPercentile(95)
+			<< ", \"p99\": " << stages[i].GetPercentile(99)
+			<< ", \"max\": " << stages[i].GetMax()
+			<< ", \"mean\": " << stages[i].GetMean()
+			<< ", \"fps\": " << stages[i].GetFps() << "}";
+
+		first = false;
+	}
+
+	json << "}";
+	return json.str();
+}
+
+void PrintTracking(const string& title, LatencyStats& fullStages, LatencyStats& trackedStages, const double hitRate) {
+
+	cout << title << " ROI hit rate: " << fixed << setprecision(1) << hitRate * 100 << "%, speedup: " << setprecision(2)
+		<< fullStages.GetMean() / max(trackedStages.GetMean(), 1e-9) << "x" << endl << endl;
+}
+
+int main(const int argc, char** argv) {
+
+	int iterations = 5;
+	string videoDirectory = "ConeOrientation/Calibration Videos";
+	string jsonPath;
+	bool benchmarkTracking = false;
+	bool benchmarkKernels = false;
+	bool benchmarkGeometry = false;
+	bool benchmarkFilter = false;
+
+	Parameters parameters = Parameters();
+
+	for (int i = 1; i < argc; i++) {
+
+		const string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--roi") {
+			benchmarkTracking = true;
+
+		} else if (argument == "--kernels") {
+			benchmarkKernels = true;
+
+		} else if (argument == "--geometry") {
+			benchmarkGeometry = true;
+
+		} else if (argument == "--filter") {
+			benchmarkFilter = true;
+
+		} else if (argument == "--multi") {
+			parameters.MultiCone = 1;
+
+		} else if (argument == "--iterations" && hasValue) {
+			iterations = max(1, stoi(argv[++i]));
+
+		} else if (argument == "--videos" && hasValue) {
+			videoDirectory = argv[++i];
+
+		} else if (argument == "--mask-mode" && hasValue) {
+			parameters.ColorMaskMode = stoi(argv[++i]);
+
+		} else if (argument == "--contours" && hasValue) {
+			parameters.ContourMethod = stoi(argv[++i]);
+
+		} else if (argument == "--pyramid" && hasValue) {
+			parameters.PyramidLevels = stoi(argv[++i]);
+
+		} else if (argument == "--alpha" && hasValue) {
+			parameters.FilterAlpha = stoi(argv[++i]);
+
+		} else if (argument == "--beta" && hasValue) {
+			parameters.FilterBeta = stoi(argv[++i]);
+
+		} else if (argument == "--predict" && hasValue) {
+			parameters.PredictionLatency = stoi(argv[++i]);
+
+		} else if (argument == "--json" && hasValue) {
+			jsonPath = argv[++i];
+
+		} else {
+			cerr << "Unknown argument " << argument << endl;
+			return 1;
+		}
+	}
+
+	if (benchmarkKernels) {
+		return RunKernelBenchmark(videoDirectory, iterations, parameters);
+	}
+
+	if (benchmarkGeometry) {
+		return RunGeometryBenchmark(videoDirectory, iterations, parameters);
+	}
+
+	if (benchmarkFilter) {
+		return RunFilterBenchmark(videoDirectory, parameters);
+	}
+
+	Parameters trackingParameters = parameters;
+	trackingParameters.RoiTracking = 1;
+
+	vector<VideoResult> results, trackedResults;
+	LatencyStats overallStages[STAGE_COUNT], overallTrackedStages[STAGE_COUNT];
+	int overallFrameCount = 0;
+	int overallConeFrameCount = 0;
+	int overallTrackedConeFrameCount = 0;
+	long long trackedRegionFrames = 0;
+	double trackedRegionHits = 0;
+
+	for (const string& video : CALIBRATION_VIDEOS) {
+
+		VideoResult result;
+		result.Name = video;
+
+		if (!BenchmarkVideo(CalibrationVideoPath(videoDirectory, video), iterations, parameters, result)) {
+			cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+			return 1;
+		}
+
+		PrintTable(video, result.FrameCount, result.ConeFrameCount, result.Stages);
+
+		for (int i = 0; i < STAGE_COUNT; i++) {
+			overallStages[i].Add(result.Stages[i]);
+		}
+
+		overallFrameCount += result.FrameCount;
+		overallConeFrameCount += result.ConeFrameCount;
+
+		if (benchmarkTracking) {
+
+			VideoResult trackedResult;
+			trackedResult.Name = video;
+
+			BenchmarkVideo(CalibrationVideoPath(videoDirectory, video), iterations, trackingParameters, trackedResult);
+
+			PrintTable(video + " with ROI tracking", trackedResult.FrameCount, trackedResult.ConeFrameCount, trackedResult.Stages);
+			PrintTracking(video, result.Stages[TOTAL_STAGE], trackedResult.Stages[TOTAL_STAGE], trackedResult.RoiHitRate);
+
+			for (int i = 0; i < STAGE_COUNT; i++) {
+				overallTrackedStages[i].Add(trackedResult.Stages[i]);
+			}
+			overallTrackedConeFrameCount += trackedResult.ConeFrameCount;
+
+			trackedRegionFrames += trackedResult.RoiFrameCount;
+			trackedRegionHits += trackedResult.RoiHitRate * trackedResult.RoiFrameCount;
+
+			trackedResults.push_back(move(trackedResult));
+		}
+
+		results.push_back(move(result));
+	}
+
+	PrintTable("All videos", overallFrameCount, overallConeFrameCount, overallStages);
+
+	const double overallHitRate = trackedRegionFrames == 0 ? 0 : trackedRegionHits / trackedRegionFrames;
+
+	if (benchmarkTracking) {
+		PrintTable("All videos with ROI tracking", overallFrameCount, overallTrackedConeFrameCount, overallTrackedStages);
+		PrintTracking("All videos", overallStages[TOTAL_STAGE], overallTrackedStages[TOTAL_STAGE], overallHitRate);
+	}
+
+	if (jsonPath.empty()) {
+		return 0;
+	}
+
+	ofstream json(jsonPath);
+
+	json << "{\n  \"iterations\": " << iterations << ",\n  \"maskMode\": " << parameters.ColorMaskMode
+		<< ",\n  \"contourMethod\": " << parameters.ContourMethod << ",\n  \"pyramidLevels\": " << parameters.PyramidLevels << ",\n  \"videos\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		json << "    {\"name\": \"" << results[i].Name << "\", \"frames\": " << results[i].FrameCount
+			<< ", \"coneFrames\": " << results[i].ConeFrameCount << ", \"stages\": " << StagesJson(results[i].Stages);
+
+		if (benchmarkTracking) {
+			json << ", \"tracking\": {\"coneFrames\": " << trackedResults[i].ConeFrameCount << ", \"roiHitRate\": " << trackedResults[i].RoiHitRate
+				<< ", \"stages\": " << StagesJson(trackedResults[i].Stages) << "}";
+		}
+
+		json << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	json << "  ],\n  \"overall\": {\"frames\": " << overallFrameCount << ", \"coneFrames\": " << overallConeFrameCount
+		<< ", \"stages\": " << StagesJson(overallStages);
+
+	if (benchmarkTracking) {
+		json << ", \"tracking\": {\"coneFrames\": " << overallTrackedConeFrameCount << ", \"roiHitRate\": " << overallHitRate
+			<< ", \"stages\": " << StagesJson(overallTrackedStages) << "}";
+	}
+
+	json << "}\n}\n";
+
+	cout << "Wrote " << jsonPath << endl;
+	return 0;
+}
\ No newline at end of file
@@ -7,7 +7,7 @@ using namespace std::chrono;
 
 
 inline void DrawConeDetails(Mat& targetImage, const vector<Point2i>& coneContour, const ConeDetails& coneDetails,
-	const vector<vector<Point2i>>& cornerGroups, MultiImageWindow& guiWindow) {
+	const CornerGroupList& cornerGroups, MultiImageWindow& guiWindow) {
 
 	if (coneContour.empty()) {
 		guiWindow.AddImage(targetImage, 1, 2, "Contours");
@@ -19,12 +19,10 @@ inline void DrawConeDetails(Mat& targetImage, const vector<Point2i>& coneContour
 		DistanceBetweenPoints(coneDetails.GetCentroidCameraPosition(), coneDetails.GetTipCameraPosition()) * 0.85, GREEN, 2);
 
 	// draw dots on corner group points
-	int colorIndex = 0;
-	for (const vector<Point2i>& cornerGroup : cornerGroups) {
-		for (const Point2i point : cornerGroup) {
-			drawMarker(targetImage, point, GetColorByIndex(colorIndex));
+	for (int group = 0; group < cornerGroups.GetGroupCount(); group++) {
+		for (const Point2i* point = cornerGroups.GroupBegin(group); point != cornerGroups.GroupEnd(group); point++) {
+			drawMarker(targetImage, *point, GetColorByIndex(group));
 		}
-		colorIndex++;
 	}
 
 	// outline cone
@@ -43,35 +41,53 @@ inline void DrawConeDetails(Mat& targetImage, const vector<Point2i>& coneContour
 	guiWindow.AddImage(targetImage, 1, 2, "Contours");
 }
 
-#ifdef FROM_WEBCAM
-inline vector<VideoCapture> CreateWebCamVideoCaptures() {
+/**
+ * \brief Draws every cone multi cone mode found, numbered by their distance.
+ */
+inline void DrawAllConeDetails(Mat& targetImage, const PipelineContext& context, MultiImageWindow& guiWindow) {
 
-	vector<VideoCapture> videoCaptures = vector<VideoCapture>();
+	for (size_t rank = 0; rank < context.CandidateOrder.size(); rank++) {
 
-	for (int i = 0; i < 4; i++) {
-		videoCaptures.emplace_back(i);
+		const int i = context.CandidateOrder[rank];
+		const ConeDetails& coneDetails = context.CandidateDetails[i];
+		const CornerGroupList& cornerGroups = context.CandidateBuffers[i].CornerGroups;
+
+		// draw dots on corner group points
+		for (int group = 0; group < cornerGroups.GetGroupCount(); group++) {
+			for (const Point2i* point = cornerGroups.GroupBegin(group); point != cornerGroups.GroupEnd(group); point++) {
+				drawMarker(targetImage, *point, GetColorByIndex(group));
+			}
+		}
+
+		// outline cone
+		DrawContour(targetImage, context.Contours[context.CandidateIndices[i]], MAGENTA);
+
+		// draw line from centroid to tip
+		line(targetImage, coneDetails.GetTipCameraPosition(), coneDetails.GetCentroidCameraPosition(), RED);
+
+		// number the cone and write its details on screen
+		putText(targetImage, to_string(rank + 1), coneDetails.GetCentroidCameraPosition(), 0, 0.75, GREEN);
+
+		const string text = to_string(rank + 1) + " X:" + to_string(coneDetails.GetCentroidPosition().x) +
+			", Y:" + to_string(coneDetails.GetCentroidPosition().y) +
+			", A:" + to_string(coneDetails.GetAngle() * 180 / PI);
+
+		putText(targetImage, text, Point2i(20, 45 + 25 * (int)rank), 0, 0.75, GREEN);
 	}
 
-	return videoCaptures;
+	guiWindow.AddImage(targetImage, 1, 2, "Contours");
 }
-#endif
 
-#ifdef FROM_FILE
-inline vector<Mat> ReadAllFrames() {
-
-	vector<Mat> frames = vector<Mat>();
+#ifdef FROM_WEBCAM
+inline vector<VideoCapture> CreateWebCamVideoCaptures() {
 
-	Mat frame;
-	VideoCapture videoCapture(FROM_FILE);
-	videoCapture.read(frame);
-	videoCapture.read(frame);
+	vector<VideoCapture> videoCaptures = vector<VideoCapture>();
 
-	while (frame.rows != 0) {
-		frames.push_back(frame.clone());
-		videoCapture.read(frame);
+	for (int i = 0; i < 4; i++) {
+		videoCaptures.emplace_back(i);
 	}
 
-	return frames;
+	return videoCaptures;
 }
 #endif
 
@@ -0,0 +1,19 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+
+// The recordings in "Calibration Videos" that the benchmark and the regression corpus replay, without the extension.
+const vector<string> CALIBRATION_VIDEOS = { "PAC 4", "PAC 5", "PAC 6", "Pit 1" };
+
+/**
+ * \param directory The directory containing the calibration videos.
+ * \param video One of CALIBRATION_VIDEOS.
+ */
+inline string CalibrationVideoPath(const string& directory, const string& video) {
+	return directory + "/" + video + ".mp4";
+}
\ No newline at end of file
@@ -0,0 +1,359 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "FrameSource.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+const char FRAME_CACHE_MAGIC[8] = { 'C', 'O', 'N', 'E', 'F', 'R', 'M', '3' };
+
+/**
+ * \brief The header at the start of a frame cache file. The frames follow at DataOffset, each FrameSize bytes apart, with rows Stride
+ *  bytes apart. Every frame of the video has a slot, the ones that could not be decoded are left empty and flagged, so the frame indices
+ *  are those of the video.
+ */
+struct FrameCacheHeader {
+
+	char Magic[8];
+	int32_t Width;
+	int32_t Height;
+	int32_t Type;
+	int32_t FrameCount;
+	int64_t Stride;
+	int64_t FrameSize;
+	int64_t DataOffset;
+	// one byte per frame, 1 if the frame was decoded into its slot and 0 if it could not be
+	int64_t FrameFlagsOffset;
+	// the size and the modification time of the video the cache was decoded from, to notice when the video was replaced
+	int64_t SourceFileSize;
+	int64_t SourceModificationTime;
+};
+
+inline int64_t AlignUp(const int64_t value, const int64_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+inline int64_t GetFileSize(const string& path) {
+
+	ifstream file(path, ios::binary | ios::ate);
+	return file ? (int64_t)file.tellg() : -1;
+}
+
+/**
+ * \return The last modification time of a file in seconds since the epoch, or -1 if it does not exist.
+ */
+inline int64_t GetFileModificationTime(const string& path) {
+
+#ifdef _WIN32
+	struct _stat64 status;
+	return _stat64(path.c_str(), &status) == 0 ? (int64_t)status.st_mtime : -1;
+#else
+	struct stat status;
+	return stat(path.c_str(), &status) == 0 ? (int64_t)status.st_mtime : -1;
+#endif
+}
+
+/**
+ * \brief Decodes every frame of a video, except the skipped first one, into a frame cache file. The frames are the ones
+ *  StreamingFrameSource reads: a frame that fails to decode is retried once after seeking to it, and if that fails too, or the frame has
+ *  a different size than the first one, its slot is left empty and flagged instead of ending the cache there.
+ * \return False if the video could not be read or the cache could not be written.
+ */
+inline bool WriteFrameCache(const string& videoPath, const string& cachePath) {
+
+	VideoCapture capture(videoPath);
+
+	if (!capture.isOpened()) {
+		return false;
+	}
+
+	const int frameCount = max(0, (int)capture.get(CAP_PROP_FRAME_COUNT) - SKIPPED_VIDEO_FRAMES);
+	capture.set(CAP_PROP_POS_FRAMES, SKIPPED_VIDEO_FRAMES);
+
+	ofstream cache(cachePath, ios::binary | ios::trunc);
+
+	if (!cache) {
+		return false;
+	}
+
+	FrameCacheHeader header{};
+	memcpy(header.Magic, FRAME_CACHE_MAGIC, sizeof(header.Magic));
+	header.FrameFlagsOffset = sizeof(header);
+	header.DataOffset = AlignUp(header.FrameFlagsOffset + frameCount, 4096);
+	header.SourceFileSize = GetFileSize(videoPath);
+	header.SourceModificationTime = GetFileModificationTime(videoPath);
+
+	// the frame count is written last, so a cache that was not finished is never used
+	cache.write((const char*)&header, sizeof(header));
+	cache.write(vector<char>((size_t)(header.DataOffset - header.FrameFlagsOffset), 0).data(), header.DataOffset - header.FrameFlagsOffset);
+
+	vector<char> frameFlags((size_t)frameCount, 0);
+	vector<char> padding;
+	// the frames before the first decodable one, whose slots can only be written once the frame size is known
+	int pendingEmptySlots = 0;
+
+	Mat frame;
+
+	for (int index = 0; index < frameCount; index++) {
+
+		bool decoded = capture.read(frame) && !frame.empty();
+
+		if (!decoded) {
+			capture.set(CAP_PROP_POS_FRAMES, index + SKIPPED_VIDEO_FRAMES);
+			decoded = capture.read(frame) && !frame.empty();
+		}
+
+		if (decoded && header.FrameSize == 0) {
+			header.Width = frame.cols;
+			header.Height = frame.rows;
+			header.Type = frame.type();
+			header.Stride = AlignUp((int64_t)frame.cols * frame.elemSize(), 64);
+			header.FrameSize = AlignUp(header.Stride * frame.rows, 4096);
+
+			padding.assign((size_t)header.FrameSize, 0);
+
+			for (; pendingEmptySlots > 0; pendingEmptySlots--) {
+				cache.write(padding.data(), header.FrameSize);
+			}
+		}
+
+		decoded = decoded && frame.cols == header.Width && frame.rows == header.Height && frame.type() == header.Type;
+
+		if (header.FrameSize == 0) {
+			pendingEmptySlots++;
+
+		} else if (!decoded) {
+			cache.write(padding.data(), header.FrameSize);
+
+		} else {
+			for (int row = 0; row < frame.rows; row++) {
+				cache.write((const char*)frame.ptr(row), frame.cols * frame.elemSize());
+				cache.write(padding.data(), header.Stride - frame.cols * frame.elemSize());
+			}
+
+			cache.write(padding.data(), header.FrameSize - header.Stride * frame.rows);
+		}
+
+		frameFlags[index] = decoded;
+	}
+
+	// without a single decodable frame there is nothing to cache
+	if (header.FrameSize == 0) {
+		return false;
+	}
+
+	header.FrameCount = frameCount;
+
+	cache.seekp(header.FrameFlagsOffset);
+	cache.write(frameFlags.data(), frameCount);
+	cache.seekp(0);
+	cache.write((const char*)&header, sizeof(header));
+
+	return (bool)cache;
+}
+
+/**
+ * \brief Serves the frames of a frame cache file straight from a read-only memory mapping, so reading a frame neither decodes nor copies.
+ */
+class MappedFrameSource : public FrameSource {
+
+		const uchar* Data = nullptr;
+		int64_t MappedSize = 0;
+		FrameCacheHeader Header{};
+
+#ifdef _WIN32
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE Mapping = nullptr;
+#endif
+
+		void Unmap() {
+
+#ifdef _WIN32
+			if (Data != nullptr) {
+				UnmapViewOfFile(Data);
+			}
+
+			if (Mapping != nullptr) {
+				CloseHandle(Mapping);
+			}
+
+			if (File != INVALID_HANDLE_VALUE) {
+				CloseHandle(File);
+			}
+
+			File = INVALID_HANDLE_VALUE;
+			Mapping = nullptr;
+#else
+			if (Data != nullptr) {
+				munmap((void*)Data, (size_t)MappedSize);
+			}
+#endif
+
+			Data = nullptr;
+			MappedSize = 0;
+		}
+
+		bool Map(const string& path) {
+
+#ifdef _WIN32
+			File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (File == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			GetFileSizeEx(File, &size);
+			MappedSize = size.QuadPart;
+
+			Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (Mapping == nullptr) {
+				return false;
+			}
+
+			Data = (const uchar*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+			return Data != nullptr;
+#else
+			const int file = open(path.c_str(), O_RDONLY);
+
+			if (file < 0) {
+				return false;
+			}
+
+			struct stat status;
+			fstat(file, &status);
+			MappedSize = status.st_size;
+
+			void* data = MappedSize > 0 ? mmap(nullptr, (size_t)MappedSize, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+			close(file);
+
+			if (data == MAP_FAILED) {
+				return false;
+			}
+
+			Data = (const uchar*)data;
+			return true;
+#endif
+		}
+
+	public:
+
+		MappedFrameSource(const string& cachePath) {
+
+			if (!Map(cachePath) || MappedSize < (int64_t)sizeof(FrameCacheHeader)) {
+				Unmap();
+				return;
+			}
+
+			memcpy(&Header, Data, sizeof(Header));
+
+			const bool valid = memcmp(Header.Magic, FRAME_CACHE_MAGIC, sizeof(Header.Magic)) == 0 && Header.FrameCount > 0 &&
+				Header.FrameFlagsOffset + Header.FrameCount <= Header.DataOffset &&
+				Header.DataOffset + Header.FrameSize * Header.FrameCount <= MappedSize;
+
+			if (!valid) {
+				Header = FrameCacheHeader{};
+				Unmap();
+			}
+		}
+
+		MappedFrameSource(const MappedFrameSource&) = delete;
+		MappedFrameSource& operator=(const MappedFrameSource&) = delete;
+
+		~MappedFrameSource() override {
+			Unmap();
+		}
+
+		bool IsValid() const {
+			return Data != nullptr;
+		}
+
+		/**
+		 * \brief Whether the cache was decoded from the video as it is now. A video replaced by one of the same size is still noticed by
+		 *  its modification time.
+		 */
+		bool IsCacheOf(const string& videoPath) const {
+			return Header.SourceFileSize == GetFileSize(videoPath) && Header.SourceModificationTime == GetFileModificationTime(videoPath);
+		}
+
+		int GetFrameCount() override {
+			return Header.FrameCount;
+		}
+
+		/**
+		 * \brief Points the target image at the frame inside the mapping without copying it. The mapping is read-only, so the image must
+		 *  not be written to.
+		 * \return False if the index is out of range or the frame could not be decoded when the cache was written.
+		 */
+		bool ReadFrame(const int index, Mat& targetImage) override {
+
+			if (index < 0 || index >= Header.FrameCount || Data[Header.FrameFlagsOffset + index] == 0) {
+				return false;
+			}
+
+			const uchar* frame = Data + Header.DataOffset + Header.FrameSize * index;
+			targetImage = Mat(Header.Height, Header.Width, Header.Type, (void*)frame, (size_t)Header.Stride);
+
+			return true;
+		}
+
+};
+
+/**
+ * \brief Opens a video as a frame source. With useCache, the video is decoded into "<video>.frames" next to it the first time, and that
+ *  file is memory mapped on every later run. Falls back to streaming the video if the cache cannot be used.
+ */
+inline unique_ptr<FrameSource> OpenFrameSource(const string& videoPath, const bool useCache) {
+
+	if (useCache) {
+
+		const string cachePath = videoPath + ".frames";
+		unique_ptr<MappedFrameSource> mapped(new MappedFrameSource(cachePath));
+
+		if (!mapped->IsValid() || !mapped->IsCacheOf(videoPath)) {
+
+			mapped.reset();
+			cout << "Decoding " << videoPath << " into " << cachePath << endl;
+
+			if (WriteFrameCache(videoPath, cachePath)) {
+				mapped.reset(new MappedFrameSource(cachePath));
+			}
+		}
+
+		if (mapped && mapped->IsValid()) {
+			return move(mapped);
+		}
+
+		cout << "Could not use the frame cache " << cachePath << ", streaming the video instead" << endl;
+	}
+
+	return unique_ptr<FrameSource>(new StreamingFrameSource(videoPath));
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+using namespace cv;
+using namespace std;
+
+
+
+// the first frame of the recordings is skipped, like the calibration tool always did
+const int SKIPPED_VIDEO_FRAMES = 1;
+
+/**
+ * \brief Random access to the frames of a recording.
+ */
+class FrameSource {
+
+	public:
+
+		virtual ~FrameSource() = default;
+
+		/**
+		 * \brief The number of frames in the recording, including any that turn out not to be decodable.
+		 */
+		virtual int GetFrameCount() = 0;
+
+		/**
+		 * \brief Sets the target image to a frame. The image can share memory with the source, so treat it as read-only.
+		 * \return False if the index is out of range or the frame could not be decoded, in which case the target image is unchanged.
+		 */
+		virtual bool ReadFrame(int index, Mat& targetImage) = 0;
+
+};
+
+/**
+ * \brief Decodes a video on a background thread and keeps a bounded LRU cache of decoded frames around the current index. The frames in
+ *  the direction the user last moved in are decoded ahead of time, so stepping and scrubbing through the video only waits for the
+ *  decoder when jumping far away.
+ */
+class StreamingFrameSource : public FrameSource {
+
+		const int CacheCapacity;
+		const int PrefetchDistance;
+
+		VideoCapture Capture;
+		int DecoderPosition = 0;
+
+		mutex Mutex;
+		condition_variable StateChanged;
+		thread DecoderThread;
+		bool Running = true;
+
+		int FrameCount = 0;
+		int CurrentIndex = 0;
+		int Direction = 1;
+		int RequestedIndex = -1;
+
+		list<int> RecentlyUsed;
+		unordered_map<int, pair<Mat, list<int>::iterator>> Cache;
+		vector<Mat> SpareBuffers;
+
+		// frames that failed to decode even after seeking to them again, they are never decoded again
+		unordered_set<int> UndecodableFrames;
+
+		bool IsCached(const int index) const {
+			return Cache.find(index) != Cache.end();
+		}
+
+		bool IsUndecodable(const int index) const {
+			return UndecodableFrames.find(index) != UndecodableFrames.end();
+		}
+
+		bool NeedsDecoding(const int index) const {
+			return !IsCached(index) && !IsUndecodable(index);
+		}
+
+		/**
+		 * \brief The requested frame if it is missing, otherwise the first missing frame of the prefetch window, or -1 if there is nothing
+		 *  to decode. When scrubbing backwards the window is filled from its far end so the decoder can read sequentially.
+		 */
+		int NextFrameToDecode() const {
+
+			if (RequestedIndex >= 0 && RequestedIndex < FrameCount && NeedsDecoding(RequestedIndex)) {
+				return RequestedIndex;
+			}
+
+			const int first = Direction > 0 ? CurrentIndex : max(0, CurrentIndex - PrefetchDistance);
+			const int last = Direction > 0 ? min(FrameCount - 1, CurrentIndex + PrefetchDistance) : CurrentIndex;
+
+			for (int index = first; index <= last; index++) {
+				if (NeedsDecoding(index)) {
+					return index;
+				}
+			}
+
+			return -1;
+		}
+
+		/**
+		 * \brief Decodes a frame, reading on from the current decoder position when the frame is a little ahead and seeking otherwise.
+		 * \param seek Seeks to the frame even if it is a little ahead.
+		 */
+		bool Decode(const int index, Mat& targetImage, const bool seek) {
+
+			const int framesAhead = index - DecoderPosition;
+
+			if (seek || framesAhead < 0 || framesAhead > PrefetchDistance) {
+				Capture.set(CAP_PROP_POS_FRAMES, index + SKIPPED_VIDEO_FRAMES);
+
+			} else {
+				for (int i = 0; i < framesAhead; i++) {
+					Capture.grab();
+				}
+			}
+
+			DecoderPosition = index + 1;
+			return Capture.read(targetImage) && !targetImage.empty();
+		}
+
+		void Touch(const int index) {
+
+			pair<Mat, list<int>::iterator>& entry = Cache[index];
+			RecentlyUsed.splice(RecentlyUsed.begin(), RecentlyUsed, entry.second);
+		}
+
+		void Insert(const int index, Mat& image) {
+
+			RecentlyUsed.push_front(index);
+			Cache[index] = make_pair(image, RecentlyUsed.begin());
+
+			while ((int)Cache.size() > CacheCapacity) {
+
+				// the frame being shown is never evicted, even if prefetching has made it the least recently used one
+				auto evicted = prev(RecentlyUsed.end());
+
+				if (*evicted == CurrentIndex) {
+					RecentlyUsed.splice(RecentlyUsed.begin(), RecentlyUsed, evicted);
+					evicted = prev(RecentlyUsed.end());
+				}
+
+				SpareBuffers.push_back(Cache[*evicted].first);
+				Cache.erase(*evicted);
+				RecentlyUsed.erase(evicted);
+			}
+		}
+
+		void DecodeLoop() {
+
+			unique_lock<mutex> lock(Mutex);
+
+			while (true) {
+
+				int index = -1;
+				StateChanged.wait(lock, [&] { return !Running || (index = NextFrameToDecode()) >= 0; });
+
+				if (!Running) {
+					return;
+				}
+
+				Mat image;
+
+				if (!SpareBuffers.empty()) {
+					image = SpareBuffers.back();
+					SpareBuffers.pop_back();
+				}
+
+				lock.unlock();
+				// a failed read is retried once with a seek, which recovers a decoder that lost its position while reading on
+				const bool decoded = Decode(index, image, false) || Decode(index, image, true);
+				lock.lock();
+
+				if (decoded) {
+					Insert(index, image);
+
+				} else {
+					// a damaged frame or a header that overstates the length of the video, the frames after it are still read
+					UndecodableFrames.insert(index);
+
+					if (!image.empty()) {
+						SpareBuffers.push_back(image);
+					}
+				}
+
+				StateChanged.notify_all();
+			}
+		}
+
+	public:
+
+		/**
+		 * \param cacheCapacity The maximum number of decoded frames kept in memory.
+		 * \param prefetchDistance How many frames ahead of the current one to decode in the direction of the last move.
+		 */
+		StreamingFrameSource(const string& path, const int cacheCapacity = 96, const int prefetchDistance = 30) :
+			CacheCapacity(max(cacheCapacity, 2 * prefetchDistance + 2)), PrefetchDistance(prefetchDistance), Capture(path) {
+
+			if (Capture.isOpened()) {
+				FrameCount = max(0, (int)Capture.get(CAP_PROP_FRAME_COUNT) - SKIPPED_VIDEO_FRAMES);
+				Capture.set(CAP_PROP_POS_FRAMES, SKIPPED_VIDEO_FRAMES);
+			}
+
+			Cache.reserve(CacheCapacity + 1);
+			DecoderThread = thread(&StreamingFrameSource::DecodeLoop, this);
+		}
+
+		StreamingFrameSource(const StreamingFrameSource&) = delete;
+		StreamingFrameSource& operator=(const StreamingFrameSource&) = delete;
+
+		~StreamingFrameSource() override {
+
+			{
+				lock_guard<mutex> lock(Mutex);
+				Running = false;
+			}
+
+			StateChanged.notify_all();
+			DecoderThread.join();
+		}
+
+		int GetFrameCount() override {
+
+			lock_guard<mutex> lock(Mutex);
+			return FrameCount;
+		}
+
+		/**
+		 * \brief Copies the frame into the target image, reusing its buffer if it already has the right size.
+		 */
+		bool ReadFrame(const int index, Mat& targetImage) override {
+
+			unique_lock<mutex> lock(Mutex);
+
+			if (index < 0 || index >= FrameCount) {
+				return false;
+			}
+
+			if (index != CurrentIndex) {
+				Direction = index > CurrentIndex ? 1 : -1;
+				CurrentIndex = index;
+			}
+
+			RequestedIndex = index;
+			StateChanged.notify_all();
+			StateChanged.wait(lock, [&] { return !NeedsDecoding(index); });
+			RequestedIndex = -1;
+
+			if (IsUndecodable(index)) {
+				return false;
+			}
+
+			Touch(index);
+			Cache[index].first.copyTo(targetImage);
+
+			return true;
+		}
+
+};
\ No newline at end of file
@@ -1,7 +1,7 @@
-#define SHOW_UI true;
 //#define FROM_WEBCAM true
 #define FROM_FILE "Calibration Videos/Pit 1.mp4"
-#define PRINT_TIME true;
+//#define FRAME_CACHE true
+//#define VERIFY_COLOR_MASK true
 
 #include <chrono>
 #include <iostream>
@@ -10,15 +10,23 @@
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 
+#include "../DetectionCore/AllocationCounter.h"
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/ConeDetector.h"
+#include "../DetectionCore/Detection.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelineContext.h"
+#include "../DetectionCore/PipelinePolicies.h"
+#include "../DetectionCore/Trigonometry.h"
+
 #include "Colors.h"
-#include "ConeDetails.h"
-#include "Contours.h"
-#include "Parameters.h"
-#include "Wrappers.h"
 #include "MultiImageWindow.h"
-#include "Trigonometry.h"
-#include "Points.h"
 #include "CalibrationToolOnly.h"
+#include "Trackbars.h"
+
+#ifdef FROM_FILE
+#include "FrameCache.h"
+#endif
 
 using namespace cv;
 using namespace std;
@@ -26,266 +34,108 @@ using namespace std::chrono;
 
 
 
-void CeilingToOdd(int& number) {
-
-	if (number % 2 == 0) {
-		number++;
-	}
-}
-
-void PreProcessImage(const Mat& sourceImage, Mat& targetImage, Parameters parameters, MultiImageWindow& guiWindow) {
-
-	Mat imageHsv, masksMerged, masksMergedDigitized, edges, contoursDilated;
-	Mat middleMask, highlightMask, lowLightMask;
-
-	CeilingToOdd(parameters.TotalMaskBlur);
-	CeilingToOdd(parameters.ContourDilation);
-
-	Scalar middleLowerColorLimit = Scalar(parameters.MiddleHueMin, parameters.MiddleSaturationMin, parameters.MiddleValueMin);
-	Scalar middleUpperColorLimit = Scalar(parameters.MiddleHueMax, parameters.MiddleSaturationMax, parameters.MiddleValueMax);
-
-	Scalar highlightLowerColorLimit = Scalar(parameters.HighlightHueMin, parameters.HighlightSaturationMin, parameters.HighlightValueMin);
-	Scalar highlightUpperColorLimit = Scalar(parameters.HighlightHueMax, parameters.HighlightSaturationMax, parameters.HighlightValueMax);
-
-	Scalar lowLightLowerColorLimit = Scalar(parameters.LowLightHueMin, parameters.LowLightSaturationMin, parameters.LowLightValueMin);
-	Scalar lowLightUpperColorLimit = Scalar(parameters.LowLightHueMax, parameters.LowLightSaturationMax, parameters.LowLightValueMax);
-
-	cvtColor(sourceImage, imageHsv, COLOR_BGR2HSV);
-	inRange(imageHsv, middleLowerColorLimit, middleUpperColorLimit, middleMask);
-	inRange(imageHsv, highlightLowerColorLimit, highlightUpperColorLimit, highlightMask);
-	inRange(imageHsv, lowLightLowerColorLimit, lowLightUpperColorLimit, lowLightMask);
-
-	masksMerged = parameters.MiddleMaskWeight / 100.0 * middleMask + parameters.HighlightMaskWeight / 100.0 * highlightMask + parameters.LowLightMaskWeight / 100.0 * lowLightMask;
-
-	Mat maskBlurred;
-	GaussianBlur(masksMerged, maskBlurred, Size(parameters.TotalMaskBlur, parameters.TotalMaskBlur), 5, 0);
-
-	inRange(maskBlurred, parameters.MaskThreshold, Scalar(255), masksMergedDigitized);
-
-	Canny(masksMergedDigitized, edges, parameters.CannyThreshold1, parameters.CannyThreshold2);
-
-	SquareDilate(edges, contoursDilated, parameters.ContourDilation);
-
-	copyMakeBorder(contoursDilated, targetImage, 1, 1, 1, 1, BORDER_CONSTANT, Scalar(255, 255, 255));
-
-#ifdef SHOW_UI
-	guiWindow.AddImage(middleMask, 0, 0, "W Mask");
-	guiWindow.AddImage(highlightMask, 1, 0, "H Mask");
-	guiWindow.AddImage(lowLightMask, 2, 0, "L Mask");
-
-	guiWindow.AddImage(masksMerged, 0, 1, "Masks Merged");
-	guiWindow.AddImage(maskBlurred, 1, 1, "Blurred");
-	guiWindow.AddImage(masksMergedDigitized, 2, 1, "Digitized Mask");
-
-	guiWindow.AddImage(targetImage, 0, 2, "Eroded");
-#endif
-}
-
-vector<Point2i> FindConeContour(const Mat& sourceImage, const Parameters parameters) {
-
-	vector<vector<Point2i>> contours;
-	vector<Vec4i> hierarchy;
-
-	findContours(sourceImage, contours, hierarchy, RETR_LIST, CHAIN_APPROX_NONE);
-
-	const vector<vector<Point2i>> filteredContours = FilteredContours(contours, parameters.MinContourArea, parameters.MaxContourArea);
+/**
+ * \brief Shows the captured stage images, and the details of the cone drawn on a copy of the frame, since frames from the frame source can
+ *  be read-only.
+ */
+void ShowPipeline(const CaptureStages& stages, const PipelineContext& context, const DetectionResult& result, const Mat& image,
+	const Parameters& parameters, Mat& displayImage, MultiImageWindow& guiWindow) {
 
-	if (filteredContours.empty()) {
-		return vector<Point2i>();
-	}
-
-	return *MostCentralContour(filteredContours, parameters.CameraResolution);
-}
-
-void GetConeCornerGroups(const vector<Point2i>& coneContour, const Point2i centroidCameraPosition, 
-	const Point2i farthestPointCameraPosition, vector<vector<Point2i>>& cornerGroups) {
-
-	const double distanceToTip = DistanceBetweenPoints(centroidCameraPosition, farthestPointCameraPosition);
-
-	cornerGroups = vector<vector<Point2i>>();
-	cornerGroups.emplace_back();
-
-	for (int i = 0; i < coneContour.size(); i++) {
-
-		Point2i point = coneContour[i];
-
-		if (DistanceBetweenPoints(point, centroidCameraPosition) < distanceToTip * 0.85) {
-			continue;
-		}
-
-		if (cornerGroups.back().empty()) {
-			cornerGroups.back().push_back(point);
-			continue;
-		}
-
-		const bool continuationOfPreviousCorner = coneContour[i - 1] == cornerGroups.back().back();
-		const bool notTooFarFromPreviousPoint = DistanceBetweenPoints(coneContour[i], cornerGroups.back().back()) < 15;
-		const bool closeToPreviousPoint = DistanceBetweenPoints(coneContour[i], cornerGroups.back().back()) < 6;
-
-		if ((continuationOfPreviousCorner && notTooFarFromPreviousPoint) || closeToPreviousPoint) {
-			cornerGroups.back().push_back(point);
-			continue;
-		}
+	// the individual masks are only produced by the inRange path
+	if (parameters.ColorMaskMode == COLOR_MASK_INRANGE) {
+		guiWindow.AddImage(stages.MiddleMask, 0, 0, "W Mask");
+		guiWindow.AddImage(stages.HighlightMask, 1, 0, "H Mask");
+		guiWindow.AddImage(stages.LowLightMask, 2, 0, "L Mask");
 
-		cornerGroups.emplace_back();
-		cornerGroups.back().push_back(point);
+	} else {
+		guiWindow.AddBlankImage(0, 0, "W Mask");
+		guiWindow.AddBlankImage(1, 0, "H Mask");
+		guiWindow.AddBlankImage(2, 0, "L Mask");
 	}
 
-	if (cornerGroups.size() < 2) {
-		return;
-	}
-
-	if (cornerGroups.back().back() == coneContour.back() && cornerGroups.front().front() == coneContour.front()) {
-
-		for (Point2i point : cornerGroups.back()) {
-			cornerGroups.front().push_back(point);
-		}
-
-		cornerGroups.pop_back();
-	}
-}
+	guiWindow.AddImage(stages.MasksMerged, 0, 1, "Masks Merged");
+	guiWindow.AddImage(stages.MaskBlurred, 1, 1, "Blurred");
+	guiWindow.AddImage(stages.MasksMergedDigitized, 2, 1, "Digitized Mask");
 
-vector<Point2i> GetHighestInEachCornerGroup(const vector<vector<Point2i>>& cornerGroups,
-	Point2i& highestPointInHighestCorner, Point2i& highestPointInSecondHighestCorner) {
+	// the boundary contour method does not produce the preprocessed image
+	if (parameters.ContourMethod == CONTOUR_METHOD_EDGES) {
+		guiWindow.AddImage(stages.PreProcessedImage, 0, 2, "Eroded");
 
-	vector<Point2i> northMostInEachCornerGroup{};
-
-	for (const vector<Point2i>& cornerGroup : cornerGroups) {
-
-		northMostInEachCornerGroup.push_back(cornerGroup[0]);
-
-		for (Point2i point : cornerGroup) {
-
-			if (point.y < northMostInEachCornerGroup.back().y) {
-				northMostInEachCornerGroup.pop_back();
-				northMostInEachCornerGroup.push_back(point);
-			}
-		}
+	} else {
+		guiWindow.AddBlankImage(0, 2, "Eroded");
 	}
 
-	highestPointInHighestCorner = northMostInEachCornerGroup[0].y < northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
-	highestPointInSecondHighestCorner = northMostInEachCornerGroup[0].y > northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
-	for (int i = 2; i < northMostInEachCornerGroup.size(); i++) {
+	image.copyTo(displayImage);
 
-		if (northMostInEachCornerGroup[i].y < highestPointInSecondHighestCorner.y) {
-			highestPointInSecondHighestCorner = northMostInEachCornerGroup[i];
-		}
+	if (parameters.MultiCone != 0) {
+		DrawAllConeDetails(displayImage, context, guiWindow);
 
-		if (northMostInEachCornerGroup[i].y < highestPointInHighestCorner.y) {
-			const Point2i temp = highestPointInSecondHighestCorner;
-			highestPointInSecondHighestCorner = highestPointInHighestCorner;
-			highestPointInHighestCorner = temp;
-		}
+	} else {
+		DrawConeDetails(displayImage, context.ConeContour, result.Details, context.CornerGroups, guiWindow);
 	}
 
-	return northMostInEachCornerGroup;
+	guiWindow.Show(parameters.WindowWidth, parameters.WindowHeight);
 }
 
-Point2i AdjustTipFromCornerPoints(const vector<vector<Point2i>>& cornerGroups, const Point2i currentTipPosition) {
+/**
+ * \brief Without captured stages there is nothing to show.
+ */
+void ShowPipeline(const Timing& timing, const PipelineContext& context, const DetectionResult& result, const Mat& image,
+	const Parameters& parameters, Mat& displayImage, MultiImageWindow& guiWindow) {}
 
-	if (cornerGroups.size() < 4) {
-		return currentTipPosition;
-	}
-
-	if (cornerGroups.size() == 4) {
+void PrintFrame(const Timing& timing, const PipelineContext& context, const DetectionResult& result, const RegionTracker& regionTracker,
+	const Parameters& parameters, const long long frameAllocations) {
 
-		Point2i highestPoint;
-		Point2i secondHighestPoint;
-		GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondHighestPoint);
-
-		if (highestPoint.y - secondHighestPoint.y < -5) {
-			return highestPoint;
+	cout << "Total Process Time: " << timing.GetFrameMilliseconds();
+	for (int stage = 0; stage < PIPELINE_STAGE_COUNT; stage++) {
+		if (timing.GetStageRunCount(stage) > 0) {
+			cout << ", " << PIPELINE_STAGE_NAMES[stage] << ": " << timing.GetStageMilliseconds(stage);
 		}
-
-		return Point2i((highestPoint.x + secondHighestPoint.x) / 2, (highestPoint.y + secondHighestPoint.y) / 2);
 	}
-
-	if (cornerGroups.size() == 5) {
-
-		vector<Point2i> corners{};
-
-		corners.reserve(cornerGroups.size());
-		for (const vector<Point2i>& cornerGroup : cornerGroups) {
-			corners.push_back(AveragePointInGroup(cornerGroup));
-		}
-
-		Point2i highestPoint = corners[0];
-
-		for (const Point2i point : corners) {
-			if (point.y < highestPoint.y) {
-				highestPoint = point;
-			}
-		}
-
-		return highestPoint;
+	if (parameters.RoiTracking != 0) {
+		cout << ", ROI Hit Rate: " << regionTracker.GetHitRate() * 100 << "%";
 	}
-
-	Point2i highestPoint;
-	Point2i secondNorthMost;
-	GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondNorthMost);
-
-	if (highestPoint.y - secondNorthMost.y < -5) {
-		return highestPoint;
+	if (parameters.MultiCone != 0) {
+		cout << ", Cones: " << result.Cones.size();
 	}
-
-	double sumX = 0;
-	int numberOfPoints = 0;
-
-	for (const vector<Point2i>& cornerGroup : cornerGroups) {
-
-		for (const Point2i point : cornerGroup) {
-			numberOfPoints++;
-			sumX += point.x;
-		}
+	if (parameters.ContourMethod != CONTOUR_METHOD_EDGES) {
+		cout << ", Rejected Blobs: " << context.RejectedBlobCount << " (" << context.PrefilteredBlobCount << " untraced)";
 	}
-
-	return Point2i(sumX / numberOfPoints, highestPoint.y);
-}
-
-bool ComputeConeDetails(const vector<Point2i>& coneContour, const Parameters& parameters, ConeDetails* output, vector<vector<Point2i>>& cornerGroups) {
-
-	if (coneContour.empty()) {
-		return false;
+	if (ALLOCATIONS_COUNTED) {
+		cout << ", Allocations: " << frameAllocations;
 	}
-
-	const Point2i centroid = ContourCentroid(coneContour);
-	Point2i farthestPoint = FarthestPoint(coneContour, centroid);
-
-	GetConeCornerGroups(coneContour, centroid, farthestPoint, cornerGroups);
-	farthestPoint = AdjustTipFromCornerPoints(cornerGroups, farthestPoint);
-
-	const Point2d centroidPosition = CalculateObjectDisplacement(centroid, parameters.CameraResolution, 
-		parameters.CameraFov, parameters.CameraOffset, parameters.CameraAngle);
-
-	const Point2d tipPosition = CalculateObjectDisplacement(farthestPoint, parameters.CameraResolution, 
-		parameters.CameraFov, parameters.CameraOffset, parameters.CameraAngle);
-
-	const double coneAngle = CalculateConeAngle(centroidPosition, tipPosition);
-
-	const double adjustedConeAngle = ApplyConeTippedErrorCorrection(coneAngle, centroid, parameters.CameraAngle, parameters.CameraResolution, parameters.CameraFov);
-
-	*output = ConeDetails(centroidPosition, tipPosition, centroid, farthestPoint, adjustedConeAngle);
-	return true;
+	cout << endl;
 }
 
-int main() {
+/**
+ * \brief Runs the calibration tool with a detector specialized on the debug policy. CaptureStages shows the pipeline with the trackbars,
+ *  Timing only prints the stage times and plays a file through once.
+ */
+template <typename DebugPolicy>
+void RunCalibrationTool(Parameters& parameters) {
 
 #ifdef FROM_WEBCAM
 	vector<VideoCapture> videoCaptures = CreateWebCamVideoCaptures();
 #endif
 
-	Mat image, preProcessedImage, blackedOutImage;
+	Mat image, displayImage;
 	MultiImageWindow multiImageWindow = MultiImageWindow("Pipeline", 3, 3);
-	Parameters parameters = Parameters();
+	BasicConeDetector<DebugPolicy> coneDetector(parameters);
+	const PipelineContext& context = coneDetector.GetContext();
+	InstallAllocationCounter();
 
-#ifdef SHOW_UI
-	parameters.CreateTrackbars();
-#endif
+	if (DebugPolicy::CapturesStages) {
+		CreateTrackbars(parameters);
+	}
 
 #ifdef FROM_FILE
-	vector<Mat> frames = ReadAllFrames();
+#ifdef FRAME_CACHE
+	unique_ptr<FrameSource> frameSource = OpenFrameSource(FROM_FILE, true);
+#else
+	unique_ptr<FrameSource> frameSource = OpenFrameSource(FROM_FILE, false);
+#endif
 	int currentFrameIndex = 0;
-	bool play = false;
+	bool play = !DebugPolicy::CapturesStages;
 #endif
 
 	while (true) {
@@ -300,40 +150,59 @@ int main() {
 		//}
 
 #elif defined(FROM_FILE)
-		image = frames[currentFrameIndex].clone();
-#endif
-
-#ifdef PRINT_TIME
-		time_point<steady_clock> startTime = high_resolution_clock::now();
+		if (!frameSource->ReadFrame(currentFrameIndex, image)) {
+			// a frame that could not be decoded is shown red, like a failed camera read
+			image = Mat(parameters.CameraResolution.y, parameters.CameraResolution.x, CV_8UC3, RED);
+		}
 #endif
 
-		PreProcessImage(image, preProcessedImage, parameters, multiImageWindow);
+		const long long allocationsBefore = GetAllocationCount();
 
-#ifdef PRINT_TIME
-		time_point<steady_clock> preProcessEndTime = high_resolution_clock::now();
-#endif
-
-		ConeDetails coneDetails{};
-		vector<vector<Point2i>> cornerGroups{};
-		vector<Point2i> coneContour = FindConeContour(preProcessedImage, parameters);
-		ComputeConeDetails(coneContour, parameters, &coneDetails, cornerGroups);
+		// the filter runs on the time the frames are shown at, the frames of a file have no capture time
+		const DetectionResult& result = coneDetector.Process(image);
 
-#ifdef PRINT_TIME
-		time_point<steady_clock> endTime = high_resolution_clock::now();
-		duration<double, milli> preProcessTime = preProcessEndTime - startTime;
-		duration<double, milli> duration = endTime - startTime;
-		cout << "Total Process Time: " << duration.count() << ", PreProcess Time: " << preProcessTime.count() << endl;
-#endif
+		const long long frameAllocations = GetAllocationCount() - allocationsBefore;
 
-#ifdef SHOW_UI
-		DrawConeDetails(image, coneContour, coneDetails, cornerGroups, multiImageWindow);
-		multiImageWindow.Show(parameters.WindowWidth, parameters.WindowHeight);
-#endif
+		PrintFrame(coneDetector.GetDebug(), context, result, coneDetector.GetRegionTracker(), parameters, frameAllocations);
+		ShowPipeline(coneDetector.GetDebug(), context, result, image, parameters, displayImage, multiImageWindow);
 
 #if defined(FROM_WEBCAM)
 		waitKey(1);
 #elif defined(FROM_FILE)
-		ChangeFrameBasedOnPlayStateAndKeyPresses(play, currentFrameIndex, (int)frames.size());
+		if (!DebugPolicy::CapturesStages && currentFrameIndex + 1 == frameSource->GetFrameCount()) {
+			return;
+		}
+
+		ChangeFrameBasedOnPlayStateAndKeyPresses(play, currentFrameIndex, frameSource->GetFrameCount());
 #endif
 	}
+}
+
+int main(const int argc, char** argv) {
+
+	bool showUi = true;
+
+	for (int i = 1; i < argc; i++) {
+
+		const string argument = argv[i];
+
+		if (argument == "--no-ui") {
+			showUi = false;
+
+		} else {
+			cerr << "Unknown argument " << argument << endl;
+			return 1;
+		}
+	}
+
+	Parameters parameters = Parameters();
+
+	if (showUi) {
+		RunCalibrationTool<CaptureStages>(parameters);
+
+	} else {
+		RunCalibrationTool<Timing>(parameters);
+	}
+
+	return 0;
 }
\ No newline at end of file
@@ -20,6 +20,7 @@ class MultiImageWindow {
 		uint RowCount;
 
 		Mat WholeImage;
+		Mat BlankImage;
 		vector<vector<Mat>> SubImages;
 		vector<vector<String>> SubImageNames;
 
@@ -113,11 +114,17 @@ class MultiImageWindow {
 			ColumnCount = columnCount;
 			RowCount = rowCount;
 
-			const Mat placeHolderSubImage = Mat(10, 10, CV_8UC3, GREEN);
-			SubImages = vector<vector<Mat>>(columnCount, vector<Mat>(rowCount, placeHolderSubImage));
+			SubImages = vector<vector<Mat>>(columnCount, vector<Mat>(rowCount, Mat(10, 10, CV_8UC3, GREEN)));
 			SubImageNames = vector<vector<string>>(columnCount, vector<string>(rowCount, ""));
+
+			// scaled to the sub image like any other image, so its size does not matter
+			BlankImage = Mat(10, 10, CV_8UC3, BLACK);
 		}
 
+		/**
+		 * \brief Shows an image in a sub image from the next call to Show on. The image is not copied, so it is shown as it is when Show is
+		 *  called.
+		 */
 		void AddImage(const Mat& image, const uint column, const uint row, const string& subtitle = "") {
 
 			if (row >= RowCount) {
@@ -128,13 +135,17 @@ class MultiImageWindow {
 				return;
 			}
 
-			Mat copy;
-			image.copyTo(copy);
-
-			SubImages[column][row] = copy;
+			SubImages[column][row] = image;
 			SubImageNames[column][row] = subtitle;
 		}
 
+		/**
+		 * \brief Shows an empty sub image, for a stage that did not produce its image.
+		 */
+		void AddBlankImage(const uint column, const uint row, const string& subtitle = "") {
+			AddImage(BlankImage, column, row, subtitle);
+		}
+
 		void Show(const int windowWidth, const int windowHeight) {
 
 			TotalImageWidth = max(windowWidth, 200);
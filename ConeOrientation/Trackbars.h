@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include <opencv2/highgui.hpp>
+
+#include "../DetectionCore/Parameters.h"
+
+using namespace cv;
+
+
+
+/**
+ * \brief Creates the windows with a trackbar for every tunable parameter. The trackbars write straight into the parameters, so they have to
+ *  outlive the windows.
+ */
+inline void CreateTrackbars(Parameters& parameters) {
+
+	namedWindow("General", WINDOW_NORMAL);
+	namedWindow("Wide Mask", WINDOW_NORMAL);
+	namedWindow("Highlight Mask", WINDOW_NORMAL);
+	namedWindow("Low Light Mask", WINDOW_NORMAL);
+
+	createTrackbar("CameraId", "General", &parameters.CameraId, 3);
+	createTrackbar("Window W", "General", &parameters.WindowWidth, 4000);
+	createTrackbar("Window H", "General", &parameters.WindowHeight, 2000);
+	createTrackbar("Spacer", "General", &parameters.WindowHeight, 2000);
+
+	createTrackbar("M H Min", "Wide Mask", &parameters.MiddleHueMin, 179);
+	createTrackbar("M H Max", "Wide Mask", &parameters.MiddleHueMax, 179);
+	createTrackbar("M S Min", "Wide Mask", &parameters.MiddleSaturationMin, 255);
+	createTrackbar("M S Max", "Wide Mask", &parameters.MiddleSaturationMax, 255);
+	createTrackbar("M V Min", "Wide Mask", &parameters.MiddleValueMin, 255);
+	createTrackbar("M V Max", "Wide Mask", &parameters.MiddleValueMax, 255);
+	createTrackbar("M Weight", "Wide Mask", &parameters.MiddleMaskWeight, 100);
+
+	createTrackbar("H H Min", "Highlight Mask", &parameters.HighlightHueMin, 179);
+	createTrackbar("H H Max", "Highlight Mask", &parameters.HighlightHueMax, 179);
+	createTrackbar("H S Min", "Highlight Mask", &parameters.HighlightSaturationMin, 255);
+	createTrackbar("H S Max", "Highlight Mask", &parameters.HighlightSaturationMax, 255);
+	createTrackbar("H V Min", "Highlight Mask", &parameters.HighlightValueMin, 255);
+	createTrackbar("H V Max", "Highlight Mask", &parameters.HighlightValueMax, 255);
+	createTrackbar("H Weight", "Highlight Mask", &parameters.HighlightMaskWeight, 100);
+
+	createTrackbar("L H Min", "Low Light Mask", &parameters.LowLightHueMin, 179);
+	createTrackbar("L H Max", "Low Light Mask", &parameters.LowLightHueMax, 179);
+	createTrackbar("L S Min", "Low Light Mask", &parameters.LowLightSaturationMin, 255);
+	createTrackbar("L S Max", "Low Light Mask", &parameters.LowLightSaturationMax, 255);
+	createTrackbar("L V Min", "Low Light Mask", &parameters.LowLightValueMin, 255);
+	createTrackbar("L V Max", "Low Light Mask", &parameters.LowLightValueMax, 255);
+	createTrackbar("L Weight", "Low Light Mask", &parameters.LowLightMaskWeight, 100);
+
+	createTrackbar("Mask Mode", "General", &parameters.ColorMaskMode, 2);
+	createTrackbar("Threshold", "General", &parameters.MaskThreshold, 255);
+
+	createTrackbar("C Dilation", "General", &parameters.ContourDilation, 50);
+	createTrackbar("C Method", "General", &parameters.ContourMethod, 2);
+
+	createTrackbar("Min Area", "General", &parameters.MinContourArea, 100000);
+	createTrackbar("Max Area", "General", &parameters.MaxContourArea, 100000);
+	createTrackbar("Mask Blur", "General", &parameters.TotalMaskBlur, 30);
+
+	createTrackbar("ROI Tracking", "General", &parameters.RoiTracking, 1);
+	createTrackbar("ROI Padding", "General", &parameters.RoiPadding, 200);
+	createTrackbar("Full Scan", "General", &parameters.RoiFullScanInterval, 120);
+
+	createTrackbar("Pyramid", "General", &parameters.PyramidLevels, 2);
+	createTrackbar("Pyramid Pad", "General", &parameters.PyramidPadding, 64);
+
+	createTrackbar("Ground LUT", "General", &parameters.GroundLookup, 1);
+
+	createTrackbar("Multi Cone", "General", &parameters.MultiCone, 1);
+	createTrackbar("Max Cones", "General", &parameters.MaxCones, 16);
+
+	createTrackbar("Filter", "General", &parameters.TemporalFilter, 1);
+	createTrackbar("Alpha", "General", &parameters.FilterAlpha, 100);
+	createTrackbar("Beta", "General", &parameters.FilterBeta, 100);
+	createTrackbar("Predict ms", "General", &parameters.PredictionLatency, 500);
+	createTrackbar("Timeout ms", "General", &parameters.FilterTimeout, 2000);
+}
\ No newline at end of file
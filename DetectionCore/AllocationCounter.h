@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <opencv2/core.hpp>
+
+using namespace cv;
+using namespace std;
+
+
+
+// Counts heap allocations in debug builds so the steady state of the pipeline can be checked for allocations. Both operator new and the
+// buffers of every Mat allocated through the default allocator are counted, which includes the scratch buffers OpenCV allocates inside
+// findContours, Canny and GaussianBlur, so the count is only reported. That the pipeline's own images are not reallocated is asserted by
+// BasicConeDetector instead. Include this header from exactly one translation unit.
+
+#ifdef _DEBUG
+const bool ALLOCATIONS_COUNTED = true;
+#else
+const bool ALLOCATIONS_COUNTED = false;
+#endif
+
+inline atomic<long long>& AllocationCount() {
+
+	static atomic<long long> count(0);
+	return count;
+}
+
+#ifdef _DEBUG
+void* operator new(const size_t size) {
+
+	AllocationCount()++;
+
+	void* pointer = malloc(size == 0 ? 1 : size);
+
+	if (pointer == nullptr) {
+		throw bad_alloc();
+	}
+
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+	free(pointer);
+}
+
+class CountingMatAllocator : public MatAllocator {
+
+		const MatAllocator* Allocator;
+
+	public:
+
+		CountingMatAllocator(const MatAllocator* allocator) {
+			Allocator = allocator;
+		}
+
+		UMatData* allocate(const int dims, const int* sizes, const int type, void* data, size_t* step,
+			const AccessFlag flags, const UMatUsageFlags usageFlags) const override {
+
+			if (data == nullptr) {
+				AllocationCount()++;
+			}
+
+			return Allocator->allocate(dims, sizes, type, data, step, flags, usageFlags);
+		}
+
+		bool allocate(UMatData* data, const AccessFlag accessFlags, const UMatUsageFlags usageFlags) const override {
+			return Allocator->allocate(data, accessFlags, usageFlags);
+		}
+
+		void deallocate(UMatData* data) const override {
+			Allocator->deallocate(data);
+		}
+
+};
+#endif
+
+/**
+ * \brief Starts counting Mat allocations. Does nothing outside of debug builds.
+ */
+inline void InstallAllocationCounter() {
+
+#ifdef _DEBUG
+	static CountingMatAllocator allocator = CountingMatAllocator(Mat::getDefaultAllocator());
+	Mat::setDefaultAllocator(&allocator);
+#endif
+}
+
+/**
+ * \brief The number of allocations counted so far. Always 0 outside of debug builds.
+ */
+inline long long GetAllocationCount() {
+	return AllocationCount();
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+#include "Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Batch version of AngleFromCameraCenter for many camera coordinates at once.
+ * \param angles Receives the yaw and pitch of every coordinate, count values.
+ */
+template <typename T>
+inline void AnglesFromCameraCenter(const Point2i* cameraCoordinates, const int count, const Point2i cameraResolution, const Point2d cameraFov,
+	Point_<T>* angles) {
+
+	const Point2i cameraMidpoint = Point2i(cameraResolution / 2);
+
+	// the same operations in the same order as AngleFromCameraCenter, without any branches, so the loop vectorizes
+	for (int i = 0; i < count; i++) {
+		angles[i].x = (T)(cameraCoordinates[i].x - cameraMidpoint.x) / cameraResolution.x * (T)cameraFov.x;
+		angles[i].y = (T)(cameraMidpoint.y - cameraCoordinates[i].y) / cameraResolution.y * (T)cameraFov.y;
+	}
+}
+
+/**
+ * \brief Projects camera coordinates to their displacement from the robot center on the ground, the batch version of
+ *  CalculateObjectDisplacement. The trigonometry of the projection depends on the column and the row of a pixel separately, through the yaw
+ *  and the pitch, so it is evaluated once per column and once per row of the image when the projection is created. Projecting a point is
+ *  then three table reads and one multiply-add, without any trigonometry.
+ */
+template <typename T>
+class GroundProjection {
+
+		vector<T> TanYawByColumn;
+		vector<T> HypotenuseByRow;
+		vector<T> ForwardDisplacementByRow;
+		T OffsetX;
+		int Columns;
+		int Rows;
+
+	public:
+
+		/**
+		 * \param cameraResolution The resolution of the images the coordinates are in. Coordinates outside of it are clamped to its edge.
+		 */
+		GroundProjection(const Point2i cameraResolution, const Point2d cameraFov, const Point3d cameraOffset, const Point2d cameraAngle) :
+			OffsetX((T)cameraOffset.x), Columns(cameraResolution.x), Rows(cameraResolution.y) {
+
+			TanYawByColumn.resize(Columns);
+			HypotenuseByRow.resize(Rows);
+			ForwardDisplacementByRow.resize(Rows);
+
+			// the same steps as CalculateObjectDisplacement, for the column or the row alone
+			for (int column = 0; column < Columns; column++) {
+
+				const Point2d inCameraAngle = AngleFromCameraCenter(Point2i(column, 0), cameraResolution, cameraFov);
+				TanYawByColumn[column] = (T)tan(cameraAngle.x + inCameraAngle.x);
+			}
+
+			for (int row = 0; row < Rows; row++) {
+
+				const Point2d inCameraAngle = AngleFromCameraCenter(Point2i(0, row), cameraResolution, cameraFov);
+				const double yFromCameraToObject = cameraOffset.z / tan(abs(inCameraAngle.y + cameraAngle.y));
+
+				HypotenuseByRow[row] = (T)sqrt(cameraOffset.z * cameraOffset.z + yFromCameraToObject * yFromCameraToObject);
+				ForwardDisplacementByRow[row] = (T)(yFromCameraToObject + cameraOffset.y);
+			}
+		}
+
+		/**
+		 * \brief Projects count camera coordinates into displacements.
+		 */
+		void Project(const Point2i* cameraCoordinates, const int count, Point_<T>* displacements) const {
+
+			for (int i = 0; i < count; i++) {
+
+				const int column = min(max(cameraCoordinates[i].x, 0), Columns - 1);
+				const int row = min(max(cameraCoordinates[i].y, 0), Rows - 1);
+
+				displacements[i].x = HypotenuseByRow[row] * TanYawByColumn[column] + OffsetX;
+				displacements[i].y = ForwardDisplacementByRow[row];
+			}
+		}
+
+		void Project(const vector<Point2i>& cameraCoordinates, vector<Point_<T>>& displacements) const {
+
+			displacements.resize(cameraCoordinates.size());
+			Project(cameraCoordinates.data(), (int)cameraCoordinates.size(), displacements.data());
+		}
+
+};
+
+/**
+ * \brief The single precision projection reads its tables a whole vector of points at a time.
+ */
+template <>
+inline void GroundProjection<float>::Project(const Point2i* cameraCoordinates, const int count, Point2f* displacements) const {
+
+	int i = 0;
+
+#if CV_SIMD
+	const v_int32 zero = vx_setall_s32(0);
+	const v_int32 lastColumn = vx_setall_s32(Columns - 1);
+	const v_int32 lastRow = vx_setall_s32(Rows - 1);
+	const v_float32 offsetX = vx_setall_f32(OffsetX);
+
+	for (; i <= count - v_float32::nlanes; i += v_float32::nlanes) {
+
+		v_int32 columns, rows;
+		v_load_deinterleave((const int*)(cameraCoordinates + i), columns, rows);
+
+		columns = v_min(v_max(columns, zero), lastColumn);
+		rows = v_min(v_max(rows, zero), lastRow);
+
+		const v_float32 tanYaw = v_lut(TanYawByColumn.data(), columns);
+		const v_float32 hypotenuse = v_lut(HypotenuseByRow.data(), rows);
+		const v_float32 forward = v_lut(ForwardDisplacementByRow.data(), rows);
+
+		v_store_interleave((float*)(displacements + i), v_muladd(hypotenuse, tanYaw, offsetX), forward);
+	}
+#endif
+
+	for (; i < count; i++) {
+
+		const int column = min(max(cameraCoordinates[i].x, 0), Columns - 1);
+		const int row = min(max(cameraCoordinates[i].y, 0), Rows - 1);
+
+		displacements[i].x = HypotenuseByRow[row] * TanYawByColumn[column] + OffsetX;
+		displacements[i].y = ForwardDisplacementByRow[row];
+	}
+}
+
+/**
+ * \brief Batch version of CalculateObjectDisplacement. Creates a GroundProjection for the call, keep one around instead when projecting
+ *  repeatedly with the same camera.
+ */
+template <typename T>
+inline void CalculateObjectDisplacements(const Point2i* cameraCoordinates, const int count, const Point2i cameraResolution,
+	const Point2d cameraFov, const Point3d cameraOffset, const Point2d cameraAngle, Point_<T>* displacements) {
+
+	const GroundProjection<T> projection(cameraResolution, cameraFov, cameraOffset, cameraAngle);
+	projection.Project(cameraCoordinates, count, displacements);
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+﻿#pragma once
+
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ConeDetails.h"
+#include "Contours.h"
+#include "Detection.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "PipelinePolicies.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Finds the areas of the source image that could contain a cone by masking a downsampled copy of it, and stores them in
+ *  context.Candidates, least central first. The area limits and the mask blur are scaled down with the image, the area limits with some
+ *  slack because the coarse blobs are measured differently from the full resolution contours.
+ */
+inline void FindCoarseCandidates(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context) {
+
+	const int factor = 1 << min(max(parameters.PyramidLevels, 1), 2);
+	const Size coarseSize = Size(sourceImage.cols / factor, sourceImage.rows / factor);
+
+	// the full resolution buffers are reused for the coarse pass, the candidates are refined in them afterwards. The views have no parent,
+	// so the blur does not read the full resolution mask of an earlier frame past the edges of the coarse one
+	Mat coarseImage = BufferCorner(context.CoarseImage, coarseSize);
+	Mat imageHsv = BufferCorner(context.ImageHsv, coarseSize);
+	Mat middleMask = BufferCorner(context.MiddleMask, coarseSize);
+	Mat highlightMask = BufferCorner(context.HighlightMask, coarseSize);
+	Mat lowLightMask = BufferCorner(context.LowLightMask, coarseSize);
+	Mat masksMerged = BufferCorner(context.MasksMerged, coarseSize);
+	Mat maskBlurred = BufferCorner(context.MaskBlurred, coarseSize);
+	Mat masksMergedDigitized = BufferCorner(context.MasksMergedDigitized, coarseSize);
+
+	resize(sourceImage, coarseImage, coarseSize, 0, 0, INTER_AREA);
+
+	ComputeMergedMask(coarseImage, parameters, context, imageHsv, middleMask, highlightMask, lowLightMask, masksMerged);
+
+	int coarseMaskBlur = max(3, parameters.TotalMaskBlur / factor);
+	CeilingToOdd(coarseMaskBlur);
+
+	GaussianBlur(masksMerged, maskBlurred, Size(coarseMaskBlur, coarseMaskBlur), 5.0 / factor, 0);
+
+	inRange(maskBlurred, parameters.MaskThreshold, Scalar(255), masksMergedDigitized);
+
+	findContours(masksMergedDigitized, context.CoarseContours, context.Hierarchy, RETR_EXTERNAL, CHAIN_APPROX_SIMPLE);
+
+	const double minArea = parameters.MinContourArea * 0.5 / (factor * factor);
+	const double maxArea = parameters.MaxContourArea * 1.5 / (factor * factor);
+	const int padding = parameters.PyramidPadding;
+	const Rect wholeImage = Rect(0, 0, sourceImage.cols, sourceImage.rows);
+
+	context.Candidates.clear();
+
+	for (const vector<Point2i>& contour : context.CoarseContours) {
+
+		const ContourStats stats = ComputeContourStats(contour);
+
+		if (stats.Area < minArea || stats.Area > maxArea) {
+			continue;
+		}
+
+		const Rect bounds = stats.Bounds;
+		const Rect candidate = Rect(bounds.x * factor - padding, bounds.y * factor - padding,
+			bounds.width * factor + 2 * padding, bounds.height * factor + 2 * padding);
+
+		context.Candidates.push_back(candidate & wholeImage);
+	}
+
+	const Point2i center = Point2i(sourceImage.cols / 2, sourceImage.rows / 2);
+
+	// the most central candidate usually contains the most central cone, searching it last saves searching it again
+	sort(context.Candidates.begin(), context.Candidates.end(), [&](const Rect& first, const Rect& second) {
+		return DistanceBetweenPoints((first.tl() + first.br()) / 2, center) > DistanceBetweenPoints((second.tl() + second.br()) / 2, center);
+	});
+}
+
+/**
+ * \brief Runs the stages of the full resolution pipeline that follow the preprocessing, on the region already preprocessed in the context.
+ * \return False if no cone was found.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeInPreProcessed(const Parameters& parameters, PipelineContext& context, DebugPolicy& debug, ConeDetails* output) {
+
+	debug.BeginStage(PIPELINE_STAGE_CONTOURS);
+	FindConeContour(parameters, context);
+	debug.EndStage(PIPELINE_STAGE_CONTOURS, context);
+
+	debug.BeginStage(PIPELINE_STAGE_DETAILS);
+	const bool coneFound = ComputeConeDetails(parameters, context, output);
+	debug.EndStage(PIPELINE_STAGE_DETAILS, context);
+
+	return coneFound;
+}
+
+/**
+ * \brief Runs the full resolution pipeline on a region of the source image, an empty region for the whole image.
+ * \return False if no cone was found.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeInRegion(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, const Rect& region,
+	DebugPolicy& debug, ConeDetails* output) {
+
+	debug.BeginStage(PIPELINE_STAGE_PREPROCESS);
+	PreProcessImage(sourceImage, parameters, context, region);
+	debug.EndStage(PIPELINE_STAGE_PREPROCESS, context);
+
+	return DetectConeInPreProcessed(parameters, context, debug, output);
+}
+
+/**
+ * \brief Searches for candidates at a lower resolution, then runs the full resolution pipeline inside every candidate and keeps the cone
+ *  whose contour centroid is closest to the center of the image, like MostCentralContour does for the whole image. The candidate of that
+ *  cone is searched again at the end if other candidates were searched after it, so the context holds its contour instead of theirs.
+ * \return False if no cone was found.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeCoarseToFine(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, DebugPolicy& debug,
+	ConeDetails* output) {
+
+	debug.BeginStage(PIPELINE_STAGE_COARSE);
+	FindCoarseCandidates(sourceImage, parameters, context);
+	debug.EndStage(PIPELINE_STAGE_COARSE, context);
+
+	const Point2i centerPoint = Point2i(parameters.CameraResolution.x / 2, parameters.CameraResolution.y / 2);
+	const int candidateCount = (int)context.Candidates.size();
+
+	int mostCentralCandidate = -1;
+	double smallestDistanceToCenter = 0;
+
+	for (int candidate = 0; candidate < candidateCount; candidate++) {
+
+		if (!DetectConeInRegion(sourceImage, parameters, context, context.Candidates[candidate], debug, output)) {
+			continue;
+		}
+
+		const double distanceToCenter = DistanceBetweenPoints(context.ConeStats.GetCentroid(), centerPoint);
+
+		if (mostCentralCandidate < 0 || distanceToCenter <= smallestDistanceToCenter) {
+			smallestDistanceToCenter = distanceToCenter;
+			mostCentralCandidate = candidate;
+		}
+	}
+
+	if (mostCentralCandidate < 0) {
+		context.ConeContour.clear();
+		context.CornerGroups.Clear();
+
+		return false;
+	}
+
+	if (mostCentralCandidate != candidateCount - 1) {
+		DetectConeInRegion(sourceImage, parameters, context, context.Candidates[mostCentralCandidate], debug, output);
+	}
+
+	return true;
+}
+
+/**
+ * \brief Searches for candidates at a lower resolution, then runs the full resolution pipeline inside every candidate and keeps the most
+ *  central cone.
+ * \return False if no cone was found.
+ */
+inline bool DetectConeCoarseToFine(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, ConeDetails* output) {
+
+	NoDebug debug;
+	return DetectConeCoarseToFine(sourceImage, parameters, context, debug, output);
+}
+
+/**
+ * \brief Runs the whole pipeline on the whole image, coarse to fine if PyramidLevels is set.
+ * \return False if no cone was found.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeInWholeImage(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, DebugPolicy& debug,
+	ConeDetails* output) {
+
+	if (parameters.PyramidLevels > 0) {
+		return DetectConeCoarseToFine(sourceImage, parameters, context, debug, output);
+	}
+
+	return DetectConeInRegion(sourceImage, parameters, context, Rect(), debug, output);
+}
+
+/**
+ * \brief Runs the whole pipeline on the whole image, coarse to fine if PyramidLevels is set.
+ * \return False if no cone was found.
+ */
+inline bool DetectConeInWholeImage(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, ConeDetails* output) {
+
+	NoDebug debug;
+	return DetectConeInWholeImage(sourceImage, parameters, context, debug, output);
+}
\ No newline at end of file
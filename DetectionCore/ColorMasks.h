@@ -0,0 +1,447 @@
+﻿#pragma once
+
+#include <array>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "Parameters.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+// the fixed point precision cvtColor uses for COLOR_BGR2HSV on 8 bit images
+#define HSV_SHIFT 12
+
+class HsvDivisionTables {
+
+	public:
+
+		int Saturation[256];
+		int Hue[256];
+
+		HsvDivisionTables() {
+
+			Saturation[0] = 0;
+			Hue[0] = 0;
+
+			for (int i = 1; i < 256; i++) {
+				Saturation[i] = saturate_cast<int>((255 << HSV_SHIFT) / (1.0 * i));
+				Hue[i] = saturate_cast<int>((180 << HSV_SHIFT) / (6.0 * i));
+			}
+		}
+
+};
+
+class HsvBox {
+
+	public:
+
+		int HueMin, HueMax;
+		int SaturationMin, SaturationMax;
+		int ValueMin, ValueMax;
+
+		HsvBox() {
+			HueMin = HueMax = SaturationMin = SaturationMax = ValueMin = ValueMax = 0;
+		}
+
+		HsvBox(const int hueMin, const int hueMax, const int saturationMin, const int saturationMax, const int valueMin, const int valueMax) {
+
+			HueMin = hueMin;
+			HueMax = hueMax;
+			SaturationMin = saturationMin;
+			SaturationMax = saturationMax;
+			ValueMin = valueMin;
+			ValueMax = valueMax;
+		}
+
+		bool ContainsSaturationAndValue(const int saturation, const int value) const {
+			return saturation >= SaturationMin && saturation <= SaturationMax && value >= ValueMin && value <= ValueMax;
+		}
+
+		bool ContainsHue(const int hue) const {
+			return hue >= HueMin && hue <= HueMax;
+		}
+
+};
+
+inline const HsvDivisionTables& GetHsvDivisionTables() {
+
+	static const HsvDivisionTables tables = HsvDivisionTables();
+	return tables;
+}
+
+/**
+ * \brief Merges the middle, highlight and low light masks using the mask weights. This is the reference the fused kernel is measured against.
+ */
+inline void MergeMasksWeighted(const Mat& middleMask, const Mat& highlightMask, const Mat& lowLightMask, const Parameters& parameters, Mat& targetImage) {
+
+	targetImage = parameters.MiddleMaskWeight / 100.0 * middleMask + parameters.HighlightMaskWeight / 100.0 * highlightMask + parameters.LowLightMaskWeight / 100.0 * lowLightMask;
+}
+
+/**
+ * \brief Calculates the merged mask value for every combination of the three masks. Because each mask is either 0 or 255 there are only eight
+ *  possible outputs, so they are produced by running MergeMasksWeighted itself over one row containing every combination. That keeps the rounding
+ *  of the weighted sum identical to the full frame version.
+ * \param parameters The parameters containing the mask weights.
+ * \param mergedValues The output table. Bit 0 of the index is the middle mask, bit 1 the highlight mask and bit 2 the low light mask.
+ */
+inline void ComputeMergedMaskValues(const Parameters& parameters, uchar mergedValues[8]) {
+
+	// wide enough that the weighted sum takes the same vectorized path as a full frame
+	const int width = 64;
+
+	Mat middleMask = Mat(1, width, CV_8UC1);
+	Mat highlightMask = Mat(1, width, CV_8UC1);
+	Mat lowLightMask = Mat(1, width, CV_8UC1);
+
+	for (int i = 0; i < width; i++) {
+		middleMask.at<uchar>(0, i) = i & 1 ? 255 : 0;
+		highlightMask.at<uchar>(0, i) = i & 2 ? 255 : 0;
+		lowLightMask.at<uchar>(0, i) = i & 4 ? 255 : 0;
+	}
+
+	Mat masksMerged;
+	MergeMasksWeighted(middleMask, highlightMask, lowLightMask, parameters, masksMerged);
+
+	for (int i = 0; i < 8; i++) {
+		mergedValues[i] = masksMerged.at<uchar>(0, i);
+	}
+}
+
+/**
+ * \brief Keeps the merged mask values of the mask weights it was last updated with so they are only recomputed when a weight changes.
+ */
+class MergedMaskValues {
+
+		int Weights[3] = { -1, -1, -1 };
+		uchar Values[8] = {};
+
+	public:
+
+		/**
+		 * \brief Recomputes the values if any of the mask weights changed since the last update.
+		 */
+		void Update(const Parameters& parameters) {
+
+			if (parameters.MiddleMaskWeight != Weights[0] || parameters.HighlightMaskWeight != Weights[1] || parameters.LowLightMaskWeight != Weights[2]) {
+
+				ComputeMergedMaskValues(parameters, Values);
+
+				Weights[0] = parameters.MiddleMaskWeight;
+				Weights[1] = parameters.HighlightMaskWeight;
+				Weights[2] = parameters.LowLightMaskWeight;
+			}
+		}
+
+		const uchar* Get() const {
+			return Values;
+		}
+
+};
+
+/**
+ * \brief Merges the middle, highlight and low light masks without floating point math or temporary images. Because each mask is either 0 or 255
+ *  the weighted and saturated sum can only take the eight 8 bit values in mergedValues, so each pixel picks its value with a select network
+ *  driven by the masks themselves. This matches MergeMasksWeighted bit for bit, which adding individually rounded weights would not.
+ * \param mergedValues The merged value for each mask combination as produced by ComputeMergedMaskValues.
+ * \param targetImage The merged mask. It is reallocated only when the size of the masks changes.
+ */
+inline void MergeMasksFixedPoint(const Mat& middleMask, const Mat& highlightMask, const Mat& lowLightMask, const uchar mergedValues[8], Mat& targetImage) {
+
+	CV_Assert(middleMask.type() == CV_8UC1 && highlightMask.type() == CV_8UC1 && lowLightMask.type() == CV_8UC1);
+	CV_Assert(middleMask.size() == highlightMask.size() && middleMask.size() == lowLightMask.size());
+
+	targetImage.create(middleMask.rows, middleMask.cols, CV_8UC1);
+
+#if CV_SIMD
+	const v_uint8 values[8] = {
+		vx_setall_u8(mergedValues[0]), vx_setall_u8(mergedValues[1]), vx_setall_u8(mergedValues[2]), vx_setall_u8(mergedValues[3]),
+		vx_setall_u8(mergedValues[4]), vx_setall_u8(mergedValues[5]), vx_setall_u8(mergedValues[6]), vx_setall_u8(mergedValues[7])
+	};
+#endif
+
+	for (int row = 0; row < middleMask.rows; row++) {
+
+		const uchar* middle = middleMask.ptr<uchar>(row);
+		const uchar* highlight = highlightMask.ptr<uchar>(row);
+		const uchar* lowLight = lowLightMask.ptr<uchar>(row);
+		uchar* target = targetImage.ptr<uchar>(row);
+
+		int column = 0;
+
+#if CV_SIMD
+		for (; column <= middleMask.cols - v_uint8::nlanes; column += v_uint8::nlanes) {
+
+			const v_uint8 middleLanes = vx_load(middle + column);
+			const v_uint8 highlightLanes = vx_load(highlight + column);
+			const v_uint8 lowLightLanes = vx_load(lowLight + column);
+
+			const v_uint8 withoutLowLight = v_select(highlightLanes,
+				v_select(middleLanes, values[3], values[2]), v_select(middleLanes, values[1], values[0]));
+
+			const v_uint8 withLowLight = v_select(highlightLanes,
+				v_select(middleLanes, values[7], values[6]), v_select(middleLanes, values[5], values[4]));
+
+			v_store(target + column, v_select(lowLightLanes, withLowLight, withoutLowLight));
+		}
+#endif
+
+		for (; column < middleMask.cols; column++) {
+			target[column] = mergedValues[(middle[column] & 1) | (highlight[column] & 2) | (lowLight[column] & 4)];
+		}
+	}
+}
+
+/**
+ * \brief Classifies single BGR pixels against the middle, highlight and low light HSV boxes and returns their merged mask value.
+ *  The HSV conversion follows the integer arithmetic cvtColor uses for 8 bit images so the result is bit identical to the inRange path.
+ */
+class MaskClassifier {
+
+		HsvBox Boxes[3];
+		uchar MergedValues[8];
+		const HsvDivisionTables& Tables;
+
+	public:
+
+		MaskClassifier(const Parameters& parameters, const uchar mergedValues[8]) : Tables(GetHsvDivisionTables()) {
+
+			Boxes[0] = HsvBox(parameters.MiddleHueMin, parameters.MiddleHueMax, parameters.MiddleSaturationMin,
+				parameters.MiddleSaturationMax, parameters.MiddleValueMin, parameters.MiddleValueMax);
+
+			Boxes[1] = HsvBox(parameters.HighlightHueMin, parameters.HighlightHueMax, parameters.HighlightSaturationMin,
+				parameters.HighlightSaturationMax, parameters.HighlightValueMin, parameters.HighlightValueMax);
+
+			Boxes[2] = HsvBox(parameters.LowLightHueMin, parameters.LowLightHueMax, parameters.LowLightSaturationMin,
+				parameters.LowLightSaturationMax, parameters.LowLightValueMin, parameters.LowLightValueMax);
+
+			for (int i = 0; i < 8; i++) {
+				MergedValues[i] = mergedValues[i];
+			}
+		}
+
+		/**
+		 * \brief Finds which boxes contain the pixel. Bit 0 is the middle box, bit 1 the highlight box and bit 2 the low light box.
+		 */
+		int Matches(const int b, const int g, const int r) const {
+
+			const int v = max(max(b, g), r);
+			const int difference = v - min(min(b, g), r);
+			const int s = (difference * Tables.Saturation[v] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+
+			int candidates = 0;
+			for (int i = 0; i < 3; i++) {
+				if (Boxes[i].ContainsSaturationAndValue(s, v)) {
+					candidates |= 1 << i;
+				}
+			}
+
+			// the hue is only worth computing if one of the boxes can still match
+			if (candidates == 0) {
+				return 0;
+			}
+
+			const int vr = v == r ? -1 : 0;
+			const int vg = v == g ? -1 : 0;
+
+			int h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * difference)) + (~vg & (r - g + 4 * difference))));
+			h = (h * Tables.Hue[difference] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+			h += h < 0 ? 180 : 0;
+
+			int matches = 0;
+			for (int i = 0; i < 3; i++) {
+				if ((candidates & 1 << i) && Boxes[i].ContainsHue(h)) {
+					matches |= 1 << i;
+				}
+			}
+
+			return matches;
+		}
+
+		uchar Classify(const int b, const int g, const int r) const {
+			return MergedValues[Matches(b, g, r)];
+		}
+
+		uchar MergedValue(const int matches) const {
+			return MergedValues[matches];
+		}
+
+};
+
+/**
+ * \brief Produces the same image as converting to HSV, taking the middle, highlight and low light inRange masks and merging them with
+ *  MergeMasksWeighted, but reads each BGR pixel only once and never materializes the HSV image or the individual masks.
+ * \param sourceImage An 8 bit BGR image.
+ * \param targetImage The merged mask. It is reallocated only when the size of the source image changes.
+ * \param parameters The parameters containing the HSV limits.
+ * \param mergedValues The merged value for each mask combination as produced by ComputeMergedMaskValues.
+ */
+inline void FusedColorMask(const Mat& sourceImage, Mat& targetImage, const Parameters& parameters, const uchar mergedValues[8]) {
+
+	CV_Assert(sourceImage.type() == CV_8UC3);
+
+	const MaskClassifier classifier = MaskClassifier(parameters, mergedValues);
+
+	targetImage.create(sourceImage.rows, sourceImage.cols, CV_8UC1);
+
+	parallel_for_(Range(0, sourceImage.rows), [&](const Range& range) {
+
+		for (int row = range.start; row < range.end; row++) {
+
+			const uchar* source = sourceImage.ptr<uchar>(row);
+			uchar* target = targetImage.ptr<uchar>(row);
+
+			for (int column = 0; column < sourceImage.cols; column++, source += 3) {
+				target[column] = classifier.Classify(source[0], source[1], source[2]);
+			}
+		}
+	});
+}
+
+// bits kept from each BGR channel by the lookup table, 6 bits makes a 256 KiB table of 4x4x4 color cells
+#define LOOKUP_TABLE_BITS 6
+#define LOOKUP_TABLE_SHIFT (8 - LOOKUP_TABLE_BITS)
+
+/**
+ * \brief Maps quantized BGR colors straight to the merged mask value so preprocessing becomes a single gather per pixel.
+ *  Each cell of the table holds the value the exact path produces for the majority of the colors inside the cell, so the table can only
+ *  disagree with the exact path for colors in cells that straddle an edge of one of the HSV boxes. The fraction of all 2^24 BGR colors
+ *  that disagree is counted while building and exposed by GetMismatchedColorFraction, which is the accuracy bound for the current parameters.
+ */
+class ColorMaskLookupTable {
+
+		vector<uchar> Table;
+		array<int, 21> BuiltFrom = {};
+		double MismatchedColorFraction = 0;
+
+		static array<int, 21> ColorParameters(const Parameters& parameters) {
+
+			return array<int, 21>{
+				parameters.MiddleHueMin, parameters.MiddleHueMax, parameters.MiddleSaturationMin,
+				parameters.MiddleSaturationMax, parameters.MiddleValueMin, parameters.MiddleValueMax, parameters.MiddleMaskWeight,
+				parameters.HighlightHueMin, parameters.HighlightHueMax, parameters.HighlightSaturationMin,
+				parameters.HighlightSaturationMax, parameters.HighlightValueMin, parameters.HighlightValueMax, parameters.HighlightMaskWeight,
+				parameters.LowLightHueMin, parameters.LowLightHueMax, parameters.LowLightSaturationMin,
+				parameters.LowLightSaturationMax, parameters.LowLightValueMin, parameters.LowLightValueMax, parameters.LowLightMaskWeight
+			};
+		}
+
+		static int CellIndex(const int b, const int g, const int r) {
+			return (b >> LOOKUP_TABLE_SHIFT) << (2 * LOOKUP_TABLE_BITS) | (g >> LOOKUP_TABLE_SHIFT) << LOOKUP_TABLE_BITS | r >> LOOKUP_TABLE_SHIFT;
+		}
+
+		void Build(const Parameters& parameters) {
+
+			uchar mergedValues[8];
+			ComputeMergedMaskValues(parameters, mergedValues);
+
+			const MaskClassifier classifier = MaskClassifier(parameters, mergedValues);
+
+			const int cellsPerChannel = 1 << LOOKUP_TABLE_BITS;
+			const int cellWidth = 1 << LOOKUP_TABLE_SHIFT;
+
+			Table.resize(cellsPerChannel * cellsPerChannel * cellsPerChannel);
+			vector<int> mismatchesPerBlueCell = vector<int>(cellsPerChannel, 0);
+
+			parallel_for_(Range(0, cellsPerChannel), [&](const Range& range) {
+
+				for (int blueCell = range.start; blueCell < range.end; blueCell++) {
+					for (int greenCell = 0; greenCell < cellsPerChannel; greenCell++) {
+						for (int redCell = 0; redCell < cellsPerChannel; redCell++) {
+
+							int countByMatches[8] = {};
+							for (int b = blueCell * cellWidth; b < (blueCell + 1) * cellWidth; b++) {
+								for (int g = greenCell * cellWidth; g < (greenCell + 1) * cellWidth; g++) {
+									for (int r = redCell * cellWidth; r < (redCell + 1) * cellWidth; r++) {
+										countByMatches[classifier.Matches(b, g, r)]++;
+									}
+								}
+							}
+
+							// different box combinations can share a merged value so the votes are counted per value
+							uchar majorityValue = classifier.MergedValue(0);
+							int majorityCount = 0;
+							for (int i = 0; i < 8; i++) {
+
+								int count = 0;
+								for (int j = 0; j < 8; j++) {
+									if (classifier.MergedValue(j) == classifier.MergedValue(i)) {
+										count += countByMatches[j];
+									}
+								}
+
+								if (count > majorityCount) {
+									majorityCount = count;
+									majorityValue = classifier.MergedValue(i);
+								}
+							}
+
+							Table[CellIndex(blueCell * cellWidth, greenCell * cellWidth, redCell * cellWidth)] = majorityValue;
+							mismatchesPerBlueCell[blueCell] += cellWidth * cellWidth * cellWidth - majorityCount;
+						}
+					}
+				}
+			});
+
+			int mismatches = 0;
+			for (const int count : mismatchesPerBlueCell) {
+				mismatches += count;
+			}
+
+			MismatchedColorFraction = mismatches / (double)(1 << 24);
+		}
+
+	public:
+
+		/**
+		 * \brief Rebuilds the table if any of the HSV limits or mask weights changed since it was last built.
+		 * \return True if the table was rebuilt.
+		 */
+		bool Update(const Parameters& parameters) {
+
+			const array<int, 21> colorParameters = ColorParameters(parameters);
+
+			if (!Table.empty() && colorParameters == BuiltFrom) {
+				return false;
+			}
+
+			Build(parameters);
+			BuiltFrom = colorParameters;
+			return true;
+		}
+
+		/**
+		 * \brief Produces the merged mask of an 8 bit BGR image with one table lookup per pixel.
+		 */
+		void Apply(const Mat& sourceImage, Mat& targetImage) const {
+
+			CV_Assert(sourceImage.type() == CV_8UC3 && !Table.empty());
+
+			targetImage.create(sourceImage.rows, sourceImage.cols, CV_8UC1);
+
+			parallel_for_(Range(0, sourceImage.rows), [&](const Range& range) {
+
+				for (int row = range.start; row < range.end; row++) {
+
+					const uchar* source = sourceImage.ptr<uchar>(row);
+					uchar* target = targetImage.ptr<uchar>(row);
+
+					for (int column = 0; column < sourceImage.cols; column++, source += 3) {
+						target[column] = Table[CellIndex(source[0], source[1], source[2])];
+					}
+				}
+			});
+		}
+
+		/**
+		 * \brief The fraction of all 2^24 BGR colors whose table value differs from the exact path for the parameters the table was built from.
+		 */
+		double GetMismatchedColorFraction() const {
+			return MismatchedColorFraction;
+		}
+
+};
\ No newline at end of file
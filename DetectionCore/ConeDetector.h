@@ -0,0 +1,182 @@
+﻿#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "CoarseToFine.h"
+#include "ConeDetails.h"
+#include "ConeFilter.h"
+#include "MultiCone.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "PipelinePolicies.h"
+#include "RegionOfInterest.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief What the detector found in one frame.
+ */
+struct DetectionResult {
+
+	bool ConeFound = false;
+	ConeDetails Details{}; // the cone to act on, filtered if TemporalFilter is set, the nearest one in multi cone mode
+	ConeDetails Measurement{}; // the unfiltered details of the frame, the same as Details when not filtering
+
+	vector<ConeDetails> Cones; // every cone, nearest first, only in multi cone mode
+};
+
+/**
+ * \brief Whether the detector preprocesses the whole image of every frame with these parameters, so the preprocessing can run ahead of the
+ *  rest of the detection. Region tracking and the coarse to fine search pick the part of the image to preprocess from the previous frame
+ *  or from the coarse pass, so they cannot.
+ */
+inline bool PreProcessesWholeImage(const Parameters& parameters) {
+	return parameters.MultiCone != 0 || (parameters.RoiTracking == 0 && parameters.PyramidLevels <= 0);
+}
+
+/**
+ * \brief The whole detection pipeline behind a single call, with the state it keeps from frame to frame. It picks the single cone, multi
+ *  cone, region tracking and filtering paths from the parameters, which are read on every frame so changing them takes effect right away.
+ *  The calibration tool, the robot and the benchmarks all detect through this, or through the same stage functions it calls.
+ *  The debug policy is called around every frame and stage. ConeDetector uses NoDebug, which compiles every hook away, while Timing and
+ *  CaptureStages record the stage times and the stage images, which GetDebug returns after each frame.
+ */
+template <typename DebugPolicy>
+class BasicConeDetector {
+
+		const Parameters& Settings;
+		PipelineTables Tables;
+		PipelineContext Context;
+		RegionTracker Tracker;
+		ConeFilter Filter;
+		DebugPolicy Debug;
+		DetectionResult Result;
+
+		void TakeNearestCone() {
+
+			if (Result.ConeFound) {
+				Result.Details = Result.Cones[0];
+				Result.Measurement = Result.Cones[0];
+			}
+		}
+
+	public:
+
+		/**
+		 * \param parameters Has to outlive the detector.
+		 */
+		BasicConeDetector(const Parameters& parameters) : Settings(parameters), Tables(parameters),
+			Context(parameters.CameraResolution, Tables) {
+			Result.Cones.reserve(16);
+		}
+
+		BasicConeDetector(const BasicConeDetector&) = delete;
+		BasicConeDetector& operator=(const BasicConeDetector&) = delete;
+
+		/**
+		 * \brief Detects the cones in a frame that was just captured.
+		 * \return The result, which is reused by the next call.
+		 */
+		const DetectionResult& Process(const Mat& sourceImage) {
+			return Process(sourceImage, steady_clock::now());
+		}
+
+		/**
+		 * \brief Detects the cones in a frame, with its capture time for the filter. Debug builds assert that the frame did not replace any
+		 *  of the context's images, the allocations inside OpenCV's own functions are only counted, by AllocationCounter.h.
+		 * \return The result, which is reused by the next call.
+		 */
+		const DetectionResult& Process(const Mat& sourceImage, const time_point<steady_clock> captureTime) {
+
+			// the parameters can change between frames, like from the trackbars of the calibration tool
+			Tables.Update(Settings);
+
+			Debug.BeginFrame();
+
+			Result.Details = ConeDetails{};
+			Result.Measurement = ConeDetails{};
+
+			if (Settings.MultiCone != 0) {
+				Result.ConeFound = DetectAllCones(sourceImage, Settings, Context, Debug, Result.Cones) > 0;
+				TakeNearestCone();
+
+			} else {
+				Result.Cones.clear();
+				Result.ConeFound = DetectConeFiltered(sourceImage, duration<double>(captureTime.time_since_epoch()).count(), Settings,
+					Context, Tracker, Filter, Debug, &Result.Measurement, &Result.Details);
+			}
+
+			Debug.EndFrame();
+
+			CV_DbgAssert(Context.BuffersUnchanged());
+
+			return Result;
+		}
+
+		/**
+		 * \brief Finishes detecting the cones in a frame whose whole image was already preprocessed into another context, like by the
+		 *  preprocessing stage of the staged pipeline, with the same filter as Process. The context has to share the tables of the detector,
+		 *  which are not updated, and PreProcessesWholeImage has to be true for the parameters.
+		 * \return The result, which is reused by the next call.
+		 */
+		const DetectionResult& ProcessPreProcessed(PipelineContext& context, const time_point<steady_clock> captureTime) {
+
+			CV_DbgAssert(&context.Tables == &Tables && PreProcessesWholeImage(Settings));
+
+			Debug.BeginFrame();
+
+			Result.Details = ConeDetails{};
+			Result.Measurement = ConeDetails{};
+
+			if (Settings.MultiCone != 0) {
+				Result.ConeFound = FindAllCones(Settings, context, Debug, Result.Cones) > 0;
+				TakeNearestCone();
+
+			} else {
+				Result.Cones.clear();
+
+				const bool coneFound = DetectConeInPreProcessed(Settings, context, Debug, &Result.Measurement);
+				Result.ConeFound = FilterConeDetails(coneFound, Result.Measurement, duration<double>(captureTime.time_since_epoch()).count(),
+					Settings, Filter, &Result.Details);
+			}
+
+			Debug.EndFrame();
+
+			return Result;
+		}
+
+		/**
+		 * \brief The tables the contexts passed to ProcessPreProcessed have to be created with.
+		 */
+		const PipelineTables& GetTables() const {
+			return Tables;
+		}
+
+		/**
+		 * \brief The buffers of the last frame, the masks, contours and candidates, to draw or inspect.
+		 */
+		const PipelineContext& GetContext() const {
+			return Context;
+		}
+
+		const RegionTracker& GetRegionTracker() const {
+			return Tracker;
+		}
+
+		const DebugPolicy& GetDebug() const {
+			return Debug;
+		}
+
+};
+
+/**
+ * \brief The production detector, with every debug hook compiled away.
+ */
+using ConeDetector = BasicConeDetector<NoDebug>;
\ No newline at end of file
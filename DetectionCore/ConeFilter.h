@@ -0,0 +1,213 @@
+﻿#pragma once
+
+#include <cmath>
+
+#include <opencv2/core.hpp>
+
+#include "ConeDetails.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "PipelinePolicies.h"
+#include "RegionOfInterest.h"
+#include "Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief One value smoothed by an alpha-beta filter, which keeps an estimate of the value and of its rate of change and corrects both by a
+ *  fixed fraction of the difference between each measurement and the prediction for it.
+ */
+struct AlphaBetaValue {
+
+	double Value = 0;
+	double Rate = 0; // per second
+
+	void Reset(const double measurement) {
+		Value = measurement;
+		Rate = 0;
+	}
+
+	double Predict(const double elapsedSeconds) const {
+		return Value + Rate * elapsedSeconds;
+	}
+
+	/**
+	 * \param residual The measurement minus Predict(elapsedSeconds).
+	 */
+	void Correct(const double residual, const double elapsedSeconds, const double alpha, const double beta) {
+		Value = Predict(elapsedSeconds) + alpha * residual;
+		Rate += beta * residual / elapsedSeconds;
+	}
+
+};
+
+/**
+ * \brief Fuses the cone details of successive frames into a smoothed estimate of where the cone is and how it moves, so the published
+ *  position and angle do not jitter from frame to frame and can be predicted ahead to make up for the pipeline latency. The motion of the
+ *  cone in the image is tracked as well, to move the search region of the next frame to where the cone is going to be.
+ */
+class ConeFilter {
+
+		bool HasCone = false;
+		double LastMeasurementTime = 0;
+		double LastUpdateTime = 0;
+
+		AlphaBetaValue X, Y, Angle;
+		AlphaBetaValue CameraX, CameraY;
+
+		// the offsets of the tip from the centroid in the last measurement, which are carried along with the smoothed centroid
+		Point2d TipOffset;
+		Point2i TipCameraOffset;
+
+		void Reset(const ConeDetails& measurement, const double time) {
+
+			X.Reset(measurement.GetCentroidPosition().x);
+			Y.Reset(measurement.GetCentroidPosition().y);
+			Angle.Reset(measurement.GetAngle());
+			CameraX.Reset(measurement.GetCentroidCameraPosition().x);
+			CameraY.Reset(measurement.GetCentroidCameraPosition().y);
+
+			HasCone = true;
+			LastUpdateTime = time;
+		}
+
+	public:
+
+		/**
+		 * \brief Adds the result of a frame. Frames without a cone only let time pass, until FilterTimeout runs out and the cone is forgotten.
+		 * \param time The capture time of the frame in seconds, increasing from frame to frame.
+		 */
+		void Update(const bool coneFound, const ConeDetails& measurement, const double time, const Parameters& parameters) {
+
+			if (!coneFound) {
+
+				if (HasCone && (time - LastMeasurementTime) * 1000 > parameters.FilterTimeout) {
+					HasCone = false;
+				}
+
+				return;
+			}
+
+			const double elapsedSeconds = time - LastUpdateTime;
+
+			if (!HasCone || elapsedSeconds <= 0 || (time - LastMeasurementTime) * 1000 > parameters.FilterTimeout) {
+				Reset(measurement, time);
+
+			} else {
+				const double alpha = parameters.FilterAlpha / 100.0;
+				const double beta = parameters.FilterBeta / 100.0;
+
+				X.Correct(measurement.GetCentroidPosition().x - X.Predict(elapsedSeconds), elapsedSeconds, alpha, beta);
+				Y.Correct(measurement.GetCentroidPosition().y - Y.Predict(elapsedSeconds), elapsedSeconds, alpha, beta);
+				CameraX.Correct(measurement.GetCentroidCameraPosition().x - CameraX.Predict(elapsedSeconds), elapsedSeconds, alpha, beta);
+				CameraY.Correct(measurement.GetCentroidCameraPosition().y - CameraY.Predict(elapsedSeconds), elapsedSeconds, alpha, beta);
+
+				// the angle is corrected along the shorter way around the circle
+				const double angleResidual = remainder(measurement.GetAngle() - Angle.Predict(elapsedSeconds), 2 * PI);
+				Angle.Correct(angleResidual, elapsedSeconds, alpha, beta);
+				Angle.Value = remainder(Angle.Value, 2 * PI);
+
+				LastUpdateTime = time;
+			}
+
+			TipOffset = measurement.GetTipPosition() - measurement.GetCentroidPosition();
+			TipCameraOffset = measurement.GetTipCameraPosition() - measurement.GetCentroidCameraPosition();
+			LastMeasurementTime = time;
+		}
+
+		/**
+		 * \brief The estimated cone details at a time, which can be ahead of the last update.
+		 * \return False if there is no cone to estimate.
+		 */
+		bool Predict(const double time, ConeDetails* output) const {
+
+			if (!HasCone) {
+				return false;
+			}
+
+			const double elapsedSeconds = time - LastUpdateTime;
+
+			const Point2d centroidPosition = Point2d(X.Predict(elapsedSeconds), Y.Predict(elapsedSeconds));
+			const Point2i centroidCameraPosition = Point2i((int)round(CameraX.Predict(elapsedSeconds)), (int)round(CameraY.Predict(elapsedSeconds)));
+
+			*output = ConeDetails(centroidPosition, centroidPosition + TipOffset, centroidCameraPosition, centroidCameraPosition + TipCameraOffset,
+				remainder(Angle.Predict(elapsedSeconds), 2 * PI));
+
+			return true;
+		}
+
+		/**
+		 * \brief How far the cone is estimated to have moved in the image between the last frame it was found in and a time, for moving the
+		 *  search region there. Only the estimated rate is extrapolated, so the noise of the last measurement and the lag of the smoothed
+		 *  position do not move the region, and it stays put for a cone that does not move.
+		 */
+		Point2i PredictCameraMotion(const double time) const {
+
+			if (!HasCone) {
+				return Point2i(0, 0);
+			}
+
+			const double elapsedSeconds = time - LastUpdateTime;
+
+			return Point2i((int)round(CameraX.Rate * elapsedSeconds), (int)round(CameraY.Rate * elapsedSeconds));
+		}
+
+		bool IsTracking() const {
+			return HasCone;
+		}
+
+};
+
+/**
+ * \brief Filters the cone measured in a frame if TemporalFilter is set, and reports it as predicted PredictionLatency milliseconds after
+ *  the capture time. Otherwise the measurement is reported as it is.
+ * \param captureTime The capture time of the frame in seconds.
+ * \return False if there is no cone, measured or still being predicted.
+ */
+inline bool FilterConeDetails(const bool coneFound, const ConeDetails& measurement, const double captureTime, const Parameters& parameters,
+	ConeFilter& filter, ConeDetails* output) {
+
+	if (parameters.TemporalFilter == 0) {
+		*output = measurement;
+		return coneFound;
+	}
+
+	filter.Update(coneFound, measurement, captureTime, parameters);
+
+	return filter.Predict(captureTime + parameters.PredictionLatency / 1000.0, output);
+}
+
+/**
+ * \brief Runs the tracked pipeline with the search region moved along with the predicted motion of the cone, and filters its result if
+ *  TemporalFilter is set. The cone is then reported as predicted PredictionLatency milliseconds after the capture time.
+ * \param captureTime The capture time of the frame in seconds.
+ * \param measurement Receives the unfiltered details of the frame.
+ * \return False if there is no cone, measured or still being predicted.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeFiltered(const Mat& sourceImage, const double captureTime, const Parameters& parameters, PipelineContext& context,
+	RegionTracker& tracker, ConeFilter& filter, DebugPolicy& debug, ConeDetails* measurement, ConeDetails* output) {
+
+	const Point2i predictedMotion = parameters.TemporalFilter != 0 ? filter.PredictCameraMotion(captureTime) : Point2i(0, 0);
+
+	const bool coneFound = DetectConeTracked(sourceImage, parameters, context, tracker, predictedMotion, debug, measurement);
+
+	return FilterConeDetails(coneFound, *measurement, captureTime, parameters, filter, output);
+}
+
+/**
+ * \brief Runs the tracked pipeline with the search region moved along with the predicted motion of the cone, and filters its result if
+ *  TemporalFilter is set. The cone is then reported as predicted PredictionLatency milliseconds after the capture time.
+ * \param captureTime The capture time of the frame in seconds.
+ * \param measurement Receives the unfiltered details of the frame.
+ * \return False if there is no cone, measured or still being predicted.
+ */
+inline bool DetectConeFiltered(const Mat& sourceImage, const double captureTime, const Parameters& parameters, PipelineContext& context,
+	RegionTracker& tracker, ConeFilter& filter, ConeDetails* measurement, ConeDetails* output) {
+
+	NoDebug debug;
+	return DetectConeFiltered(sourceImage, captureTime, parameters, context, tracker, filter, debug, measurement, output);
+}
\ No newline at end of file
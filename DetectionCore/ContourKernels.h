@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Computes the squared distance of every point to the base point and returns the index of the first point at the largest distance,
+ *  which is the point FarthestPoint picks.
+ * \param count The number of points, at least 1.
+ * \param squaredDistances Receives the squared distance of every point, count values.
+ */
+inline int FarthestPointIndexScalar(const Point2i* points, const int count, const Point2i basePoint, int* squaredDistances) {
+
+	int farthestIndex = 0;
+
+	for (int i = 0; i < count; i++) {
+
+		const int deltaX = points[i].x - basePoint.x;
+		const int deltaY = points[i].y - basePoint.y;
+
+		squaredDistances[i] = deltaX * deltaX + deltaY * deltaY;
+
+		if (squaredDistances[i] > squaredDistances[farthestIndex]) {
+			farthestIndex = i;
+		}
+	}
+
+	return farthestIndex;
+}
+
+/**
+ * \brief Same as FarthestPointIndexScalar, with the distances computed a whole vector of points at a time. The interleaved points are split
+ *  into a vector of x and a vector of y coordinates while loading, so the contour does not have to be copied into separate arrays first.
+ */
+inline int FarthestPointIndexSimd(const Point2i* points, const int count, const Point2i basePoint, int* squaredDistances) {
+
+#if CV_SIMD
+	const v_int32 baseX = vx_setall_s32(basePoint.x);
+	const v_int32 baseY = vx_setall_s32(basePoint.y);
+	v_int32 farthestDistances = vx_setall_s32(0);
+
+	int i = 0;
+
+	for (; i <= count - v_int32::nlanes; i += v_int32::nlanes) {
+
+		v_int32 x, y;
+		v_load_deinterleave((const int*)(points + i), x, y);
+
+		const v_int32 deltaX = x - baseX;
+		const v_int32 deltaY = y - baseY;
+		const v_int32 distances = deltaX * deltaX + deltaY * deltaY;
+
+		v_store(squaredDistances + i, distances);
+		farthestDistances = v_max(farthestDistances, distances);
+	}
+
+	int farthestDistance = v_reduce_max(farthestDistances);
+
+	for (; i < count; i++) {
+
+		const int deltaX = points[i].x - basePoint.x;
+		const int deltaY = points[i].y - basePoint.y;
+
+		squaredDistances[i] = deltaX * deltaX + deltaY * deltaY;
+		farthestDistance = max(farthestDistance, squaredDistances[i]);
+	}
+
+	// the first point at the largest distance, like the scalar version
+	int farthestIndex = 0;
+
+	while (squaredDistances[farthestIndex] != farthestDistance) {
+		farthestIndex++;
+	}
+
+	return farthestIndex;
+#else
+	return FarthestPointIndexScalar(points, count, basePoint, squaredDistances);
+#endif
+}
+
+/**
+ * \brief Writes the indices of the points whose squared distance is at least the threshold to indices, in order.
+ * \param indices Receives the indices, room for count values.
+ * \return The number of indices written.
+ */
+inline int RadialFilterScalar(const int* squaredDistances, const int count, const int threshold, int* indices) {
+
+	int found = 0;
+
+	for (int i = 0; i < count; i++) {
+		indices[found] = i;
+		found += squaredDistances[i] >= threshold;
+	}
+
+	return found;
+}
+
+/**
+ * \brief Same as RadialFilterScalar, but skips a whole vector of points at a time when none of them reaches the threshold, which is most of
+ *  the contour, because only the corners reach 0.85 times the distance to the tip.
+ */
+inline int RadialFilterSimd(const int* squaredDistances, const int count, const int threshold, int* indices) {
+
+	int found = 0;
+	int i = 0;
+
+#if CV_SIMD
+	const v_int32 belowThreshold = vx_setall_s32(threshold - 1);
+
+	for (; i <= count - v_int32::nlanes; i += v_int32::nlanes) {
+
+		if (!v_check_any(vx_load(squaredDistances + i) > belowThreshold)) {
+			continue;
+		}
+
+		for (int lane = i; lane < i + v_int32::nlanes; lane++) {
+			indices[found] = lane;
+			found += squaredDistances[lane] >= threshold;
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		indices[found] = i;
+		found += squaredDistances[i] >= threshold;
+	}
+
+	return found;
+}
+
+/**
+ * \brief FarthestPointIndexSimd for a whole contour, resizing squaredDistances to it.
+ */
+inline int FarthestPointIndex(const vector<Point2i>& points, const Point2i basePoint, vector<int>& squaredDistances) {
+
+	squaredDistances.resize(points.size());
+	return FarthestPointIndexSimd(points.data(), (int)points.size(), basePoint, squaredDistances.data());
+}
+
+/**
+ * \brief RadialFilterSimd for a whole contour, leaving the indices of the points at or beyond the threshold in indices.
+ */
+inline void RadialFilter(const vector<int>& squaredDistances, const int threshold, vector<int>& indices) {
+
+	indices.resize(squaredDistances.size());
+	indices.resize(RadialFilterSimd(squaredDistances.data(), (int)squaredDistances.size(), threshold, indices.data()));
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+﻿#pragma once
+
+#include <cfloat>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/types.hpp>
+
+#include "Points.h"
+
+using namespace std;
+using namespace cv;
+
+
+
+inline void DrawContour(Mat& image, const vector<Point>& contour, const Scalar& color = Scalar(0, 0, 0), const int thickness = 1) {
+
+	vector<vector<Point2i>> singleContour = vector<vector<Point2i>>();
+	singleContour.push_back(contour);
+
+	drawContours(image, singleContour, 0, color, thickness);
+}
+
+inline Point2i ContourCentroid(const vector<Point2i>& contour) {
+
+	const Moments moment = moments(contour, true);
+	return Point2i(moment.m10 / moment.m00, moment.m01 / moment.m00);
+}
+
+/**
+ * \brief The area, first order moments and bounding box of a contour, computed together in one pass over its points. There are no
+ *  farthest point candidates: the tip is the point farthest from the centroid, which is only known after the pass, and the corner groups
+ *  need the distance of every point to it anyway, so FarthestPointIndex computes them and the tip in one pass of its own.
+ */
+struct ContourStats {
+
+	double Area = 0; // the same as contourArea and the m00 of moments, which are equal for a contour
+	double M10 = 0;
+	double M01 = 0;
+	Rect Bounds;
+
+	/**
+	 * \brief The same centroid ContourCentroid computes.
+	 */
+	Point2i GetCentroid() const {
+		return Point2i(M10 / Area, M01 / Area);
+	}
+};
+
+/**
+ * \brief Computes the stats of a contour with the same sums moments and contourArea use, so the results are identical to theirs.
+ */
+inline ContourStats ComputeContourStats(const vector<Point2i>& contour) {
+
+	ContourStats stats;
+
+	if (contour.empty()) {
+		return stats;
+	}
+
+	double a00 = 0, a10 = 0, a01 = 0;
+	int minX = contour[0].x, maxX = contour[0].x, minY = contour[0].y, maxY = contour[0].y;
+
+	double previousX = contour.back().x;
+	double previousY = contour.back().y;
+
+	for (const Point2i point : contour) {
+
+		const double x = point.x;
+		const double y = point.y;
+		const double crossProduct = previousX * y - x * previousY;
+
+		a00 += crossProduct;
+		a10 += crossProduct * (previousX + x);
+		a01 += crossProduct * (previousY + y);
+
+		minX = min(minX, point.x);
+		maxX = max(maxX, point.x);
+		minY = min(minY, point.y);
+		maxY = max(maxY, point.y);
+
+		previousX = x;
+		previousY = y;
+	}
+
+	stats.Bounds = Rect(minX, minY, maxX - minX + 1, maxY - minY + 1);
+
+	// like moments, the sign of the sums follows the direction of the contour and is dropped
+	if (fabs(a00) > FLT_EPSILON) {
+
+		const double oneHalf = a00 < 0 ? -0.5 : 0.5;
+		const double oneSixth = a00 < 0 ? -1.0 / 6 : 1.0 / 6;
+
+		stats.Area = a00 * oneHalf;
+		stats.M10 = a10 * oneSixth;
+		stats.M01 = a01 * oneSixth;
+	}
+
+	return stats;
+}
+
+inline vector<vector<Point2i>> FilteredContours(const vector<vector<Point2i>>& contours, const int minArea, const int maxArea) {
+
+	vector<vector<Point2i>> filteredContours;
+
+	for (const vector<Point2i>& contour : contours) {
+
+		const double area = contourArea(contour);
+
+		if (area < minArea || area > maxArea) {
+			continue;
+		}
+
+		filteredContours.push_back(contour);
+	}
+
+	return filteredContours;
+}
+
+/**
+ * \brief Same filter as FilteredContours but computes the stats of every contour once and records the indices of the contours within the
+ *  area limits instead of copying them.
+ */
+inline void FilterContourIndices(const vector<vector<Point2i>>& contours, const int minArea, const int maxArea, vector<ContourStats>& stats,
+	vector<int>& filteredIndices) {
+
+	stats.clear();
+	filteredIndices.clear();
+
+	for (int i = 0; i < (int)contours.size(); i++) {
+
+		stats.push_back(ComputeContourStats(contours[i]));
+
+		if (stats[i].Area < minArea || stats[i].Area > maxArea) {
+			continue;
+		}
+
+		filteredIndices.push_back(i);
+	}
+}
+
+inline const vector<Point2i>* SmallestContour(const vector<vector<Point2i>>& contours) {
+
+	if (contours.empty()) {
+		return nullptr;
+	}
+
+	const vector<Point2i>* smallestContour = contours.data();
+	double smallestArea = contourArea(contours[0]);
+
+	for (const vector<Point2i>& contour : contours) {
+
+		const double currentArea = contourArea(contour);
+
+		if (currentArea < smallestArea) {
+			smallestArea = currentArea;
+			smallestContour = &contour;
+		}
+	}
+
+	return smallestContour;
+}
+
+inline const vector<Point2i>* BiggestContour(const vector<vector<Point2i>>& contours) {
+
+	if (contours.empty()) {
+		return nullptr;
+	}
+
+	const vector<Point2i>* biggestContour = contours.data();
+	double biggestArea = contourArea(contours[0]);
+
+	for (const vector<Point2i>& contour : contours) {
+
+		const double currentArea = contourArea(contour);
+
+		if (currentArea > biggestArea) {
+			biggestArea = currentArea;
+			biggestContour = &contour;
+		}
+	}
+
+	return biggestContour;
+}
+
+inline const vector<Point2i>* MostCentralContour(const vector<vector<Point2i>>& contours, const Point2i cameraResolution) {
+
+	if (contours.empty()) {
+		return nullptr;
+	}
+
+	const Point2i centerPoint = Point2i(cameraResolution.x / 2, cameraResolution.y / 2);
+
+	const vector<Point2i>* mostCentralContour = contours.data();
+	double smallestDistanceToCenter = DistanceBetweenPoints(ContourCentroid(*contours.data()), centerPoint);
+
+	for (const vector<Point2i>& contour : contours) {
+
+		const Point2i currentCentroid = ContourCentroid(contour);
+		const double currentDistanceToCenter = DistanceBetweenPoints(currentCentroid, centerPoint);
+
+		if (currentDistanceToCenter < smallestDistanceToCenter) {
+			smallestDistanceToCenter = currentDistanceToCenter;
+			mostCentralContour = &contour;
+		}
+	}
+
+	return mostCentralContour;
+}
+
+/**
+ * \brief Same as MostCentralContour but only considers the contours at the specified indices, using their precomputed stats.
+ * \return The index of the most central contour or -1 if there are no indices.
+ */
+inline int MostCentralContour(const vector<ContourStats>& stats, const vector<int>& indices, const Point2i cameraResolution) {
+
+	const Point2i centerPoint = Point2i(cameraResolution.x / 2, cameraResolution.y / 2);
+
+	int mostCentralIndex = -1;
+	double smallestDistanceToCenter = 0;
+
+	for (const int index : indices) {
+
+		const double currentDistanceToCenter = DistanceBetweenPoints(stats[index].GetCentroid(), centerPoint);
+
+		if (mostCentralIndex < 0 || currentDistanceToCenter < smallestDistanceToCenter) {
+			smallestDistanceToCenter = currentDistanceToCenter;
+			mostCentralIndex = index;
+		}
+	}
+
+	return mostCentralIndex;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core/types.hpp>
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief The corner groups of a cone contour. The groups are consecutive ranges of one point buffer instead of a vector each, so finding
+ *  them does not allocate once the buffers have grown to the largest contour.
+ */
+class CornerGroupList {
+
+		vector<Point2i> Points;
+		vector<int> GroupEnds; // the index in Points after the last point of each group, a group starts where the previous one ends
+
+	public:
+
+		CornerGroupList() {
+			Points.reserve(4096);
+			GroupEnds.reserve(16);
+		}
+
+		void Clear() {
+			Points.clear();
+			GroupEnds.clear();
+		}
+
+		int GetGroupCount() const {
+			return (int)GroupEnds.size();
+		}
+
+		int GetGroupSize(const int group) const {
+			return GroupEnds[group] - GetGroupStart(group);
+		}
+
+		int GetGroupStart(const int group) const {
+			return group == 0 ? 0 : GroupEnds[group - 1];
+		}
+
+		const Point2i* GroupBegin(const int group) const {
+			return Points.data() + GetGroupStart(group);
+		}
+
+		const Point2i* GroupEnd(const int group) const {
+			return Points.data() + GroupEnds[group];
+		}
+
+		/**
+		 * \brief The points of every group, group after group.
+		 */
+		const vector<Point2i>& GetPoints() const {
+			return Points;
+		}
+
+		void StartGroup(const Point2i point) {
+			Points.push_back(point);
+			GroupEnds.push_back((int)Points.size());
+		}
+
+		void AddToLastGroup(const Point2i point) {
+			Points.push_back(point);
+			GroupEnds.back()++;
+		}
+
+		/**
+		 * \brief Appends the points of the last group to the first group, for a corner that wraps around the start of the contour.
+		 */
+		void MergeLastGroupIntoFirst() {
+
+			const int lastGroup = GetGroupCount() - 1;
+			const int lastGroupSize = GetGroupSize(lastGroup);
+
+			rotate(Points.begin() + GroupEnds[0], Points.begin() + GetGroupStart(lastGroup), Points.end());
+
+			GroupEnds.pop_back();
+
+			for (int& groupEnd : GroupEnds) {
+				groupEnd += lastGroupSize;
+			}
+		}
+
+};
\ No newline at end of file
@@ -0,0 +1,491 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ColorMasks.h"
+#include "ConeDetails.h"
+#include "ContourKernels.h"
+#include "Contours.h"
+#include "CornerGroups.h"
+#include "GroundLookupTable.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "Points.h"
+#include "Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+// the preprocessed image has a 1 pixel border on each side, which Parameters::CameraResolution includes, so every contour is reported
+// shifted by it, whichever image it was traced on
+const Point2i PREPROCESSED_BORDER_OFFSET = Point2i(1, 1);
+
+inline void CeilingToOdd(int& number) {
+
+	if (number % 2 == 0) {
+		number++;
+	}
+}
+
+inline void ComputeInRangeMasks(const Mat& sourceImage, const Parameters& parameters, Mat& imageHsv, Mat& middleMask, Mat& highlightMask,
+	Mat& lowLightMask) {
+
+	const Scalar middleLowerColorLimit = Scalar(parameters.MiddleHueMin, parameters.MiddleSaturationMin, parameters.MiddleValueMin);
+	const Scalar middleUpperColorLimit = Scalar(parameters.MiddleHueMax, parameters.MiddleSaturationMax, parameters.MiddleValueMax);
+
+	const Scalar highlightLowerColorLimit = Scalar(parameters.HighlightHueMin, parameters.HighlightSaturationMin, parameters.HighlightValueMin);
+	const Scalar highlightUpperColorLimit = Scalar(parameters.HighlightHueMax, parameters.HighlightSaturationMax, parameters.HighlightValueMax);
+
+	const Scalar lowLightLowerColorLimit = Scalar(parameters.LowLightHueMin, parameters.LowLightSaturationMin, parameters.LowLightValueMin);
+	const Scalar lowLightUpperColorLimit = Scalar(parameters.LowLightHueMax, parameters.LowLightSaturationMax, parameters.LowLightValueMax);
+
+	cvtColor(sourceImage, imageHsv, COLOR_BGR2HSV);
+	inRange(imageHsv, middleLowerColorLimit, middleUpperColorLimit, middleMask);
+	inRange(imageHsv, highlightLowerColorLimit, highlightUpperColorLimit, highlightMask);
+	inRange(imageHsv, lowLightLowerColorLimit, lowLightUpperColorLimit, lowLightMask);
+}
+
+/**
+ * \brief Computes the merged mask of the source image with the configured color mask mode. The HSV image and the individual masks are only
+ *  written by the inRange mode.
+ */
+inline void ComputeMergedMask(const Mat& source, const Parameters& parameters, PipelineContext& context, Mat& imageHsv, Mat& middleMask,
+	Mat& highlightMask, Mat& lowLightMask, Mat& masksMerged) {
+
+	const uchar* mergedValues = context.Tables.MergedValues.Get();
+
+	if (parameters.ColorMaskMode == COLOR_MASK_FUSED) {
+		FusedColorMask(source, masksMerged, parameters, mergedValues);
+
+#ifdef VERIFY_COLOR_MASK
+		ComputeInRangeMasks(source, parameters, imageHsv, middleMask, highlightMask, lowLightMask);
+
+		Mat referenceMask;
+		MergeMasksWeighted(middleMask, highlightMask, lowLightMask, parameters, referenceMask);
+
+		cout << "Fused Mask Mismatched Pixels: " << countNonZero(referenceMask != masksMerged) << endl;
+#endif
+
+	} else if (parameters.ColorMaskMode == COLOR_MASK_LOOKUP) {
+		context.Tables.LookupTable.Apply(source, masksMerged);
+
+	} else {
+		ComputeInRangeMasks(source, parameters, imageHsv, middleMask, highlightMask, lowLightMask);
+		MergeMasksFixedPoint(middleMask, highlightMask, lowLightMask, mergedValues, masksMerged);
+	}
+}
+
+/**
+ * \brief Produces the preprocessed image of a region of the source image in context.PreProcessedImage. The region is processed in the top
+ *  left corner of the context's full size buffers, so processing a smaller region does not allocate, and its borders are extrapolated
+ *  like those of a whole image, so the result does not depend on what the buffers held before.
+ * \param region The part of the source image to process, the whole image if it is empty.
+ */
+inline void PreProcessImage(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, const Rect& region) {
+
+	int totalMaskBlur = parameters.TotalMaskBlur;
+	CeilingToOdd(totalMaskBlur);
+
+	context.Region = region.empty() ? Rect(0, 0, sourceImage.cols, sourceImage.rows) : region;
+
+	const Mat source = context.Region.size() == sourceImage.size() ? sourceImage : sourceImage(context.Region);
+	const Size regionSize = context.Region.size();
+
+	Mat imageHsv = BufferCorner(context.ImageHsv, regionSize);
+	Mat middleMask = BufferCorner(context.MiddleMask, regionSize);
+	Mat highlightMask = BufferCorner(context.HighlightMask, regionSize);
+	Mat lowLightMask = BufferCorner(context.LowLightMask, regionSize);
+	Mat masksMerged = BufferCorner(context.MasksMerged, regionSize);
+	Mat maskBlurred = BufferCorner(context.MaskBlurred, regionSize);
+	Mat masksMergedDigitized = BufferCorner(context.MasksMergedDigitized, regionSize);
+	Mat edges = BufferCorner(context.Edges, regionSize);
+	Mat contoursDilated = BufferCorner(context.ContoursDilated, regionSize);
+	Mat preProcessedImage = BufferCorner(context.PreProcessedImage, Size(regionSize.width + 2, regionSize.height + 2));
+
+	ComputeMergedMask(source, parameters, context, imageHsv, middleMask, highlightMask, lowLightMask, masksMerged);
+
+	GaussianBlur(masksMerged, maskBlurred, Size(totalMaskBlur, totalMaskBlur), 5, 0);
+
+	inRange(maskBlurred, parameters.MaskThreshold, Scalar(255), masksMergedDigitized);
+
+	// the other contour methods trace the digitized mask instead of its edges. The dilated edge band cuts through every neck of a blob
+	// that is thinner than the band, so the mask is opened with the same kernel to split the blobs where the edges method does, without
+	// changing their size. The edge image is only scratch space here, and the border image is not needed
+	if (parameters.ContourMethod != CONTOUR_METHOD_EDGES) {
+		const Mat& kernel = context.GetDilationKernel(parameters.ContourDilation);
+		erode(masksMergedDigitized, edges, kernel);
+		dilate(edges, contoursDilated, kernel);
+		return;
+	}
+
+	Canny(masksMergedDigitized, edges, parameters.CannyThreshold1, parameters.CannyThreshold2);
+
+	dilate(edges, contoursDilated, context.GetDilationKernel(parameters.ContourDilation));
+
+	copyMakeBorder(contoursDilated, preProcessedImage, 1, 1, 1, 1, BORDER_CONSTANT, Scalar(255, 255, 255));
+}
+
+/**
+ * \brief Produces the preprocessed image of the whole source image in context.PreProcessedImage. Every intermediate image is kept in the
+ *  context.
+ */
+inline void PreProcessImage(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context) {
+	PreProcessImage(sourceImage, parameters, context, Rect());
+}
+
+/**
+ * \brief Traces the outer boundary of every blob in the opened mask of the preprocessed region into context.Contours and records the
+ *  ones within the area limits. Unlike the contours of the dilated edges, there is no inner contour for each outer one and no contour
+ *  formed by the image border.
+ */
+inline void FindMaskBoundaries(const Parameters& parameters, PipelineContext& context) {
+
+	const Mat maskOpened = BufferCorner(context.ContoursDilated, context.Region.size());
+
+	findContours(maskOpened, context.Contours, context.Hierarchy, RETR_EXTERNAL, CHAIN_APPROX_NONE,
+		context.Region.tl() + PREPROCESSED_BORDER_OFFSET);
+
+	FilterContourIndices(context.Contours, parameters.MinContourArea, parameters.MaxContourArea, context.ContourStatistics,
+		context.FilteredContourIndices);
+}
+
+/**
+ * \brief Same as FindMaskBoundaries, but labels the blobs of the opened mask first and only traces the ones whose pixel count and
+ *  bounding box can be within the area limits, so the noise blobs are never traced. The number of blobs rejected without tracing is left
+ *  in context.PrefilteredBlobCount.
+ */
+inline void FindComponentBoundaries(const Parameters& parameters, PipelineContext& context) {
+
+	const Size regionSize = context.Region.size();
+	const Mat maskOpened = BufferCorner(context.ContoursDilated, regionSize);
+	Mat componentLabels = BufferCorner(context.ComponentLabels, regionSize);
+	Mat componentMask = BufferCorner(context.ComponentMask, regionSize);
+
+	const int componentCount = connectedComponentsWithStats(maskOpened, componentLabels, context.ComponentStats,
+		context.ComponentCentroids, 8, CV_32S);
+
+	context.Contours.clear();
+
+	// label 0 is the background
+	for (int label = 1; label < componentCount; label++) {
+
+		const int* stats = context.ComponentStats.ptr<int>(label);
+		const Rect bounds = Rect(stats[CC_STAT_LEFT], stats[CC_STAT_TOP], stats[CC_STAT_WIDTH], stats[CC_STAT_HEIGHT]);
+		const int pixelCount = stats[CC_STAT_AREA];
+
+		// the contour runs through the centers of the outer pixels, so its area is at most (width - 1) * (height - 1), and it can only be
+		// less than half the pixel count for blobs that are mostly one pixel wide, which the blur before digitizing does not leave
+		if ((bounds.width - 1) * (bounds.height - 1) < parameters.MinContourArea || pixelCount > 2 * parameters.MaxContourArea + 2) {
+			context.PrefilteredBlobCount++;
+			continue;
+		}
+
+		compare(componentLabels(bounds), label, componentMask(bounds), CMP_EQ);
+
+		findContours(componentMask(bounds), context.ComponentContours, RETR_EXTERNAL, CHAIN_APPROX_NONE,
+			context.Region.tl() + bounds.tl() + PREPROCESSED_BORDER_OFFSET);
+
+		for (vector<Point2i>& contour : context.ComponentContours) {
+			context.Contours.push_back(move(contour));
+		}
+	}
+
+	FilterContourIndices(context.Contours, parameters.MinContourArea, parameters.MaxContourArea, context.ContourStatistics,
+		context.FilteredContourIndices);
+}
+
+/**
+ * \brief Traces every contour of the preprocessed region into context.Contours and records the ones within the area limits, leaving out
+ *  the white border around a region smaller than the whole image.
+ */
+inline void FindEdgeContours(const Parameters& parameters, PipelineContext& context) {
+
+	const Rect borderRegion = Rect(context.Region.x, context.Region.y, context.Region.width + 2, context.Region.height + 2);
+	const Mat preProcessedImage = BufferCorner(context.PreProcessedImage, borderRegion.size());
+
+	findContours(preProcessedImage, context.Contours, context.Hierarchy, RETR_LIST, CHAIN_APPROX_NONE, borderRegion.tl());
+
+	FilterContourIndices(context.Contours, parameters.MinContourArea, parameters.MaxContourArea, context.ContourStatistics,
+		context.FilteredContourIndices);
+
+	// the white border around a small region can be within the area limits itself
+	if (borderRegion.size() != context.PreProcessedImage.size()) {
+
+		vector<int>& indices = context.FilteredContourIndices;
+		indices.erase(remove_if(indices.begin(), indices.end(), [&](const int index) {
+			return context.ContourStatistics[index].Bounds == borderRegion;
+		}), indices.end());
+	}
+}
+
+/**
+ * \brief Traces the contours of the preprocessed region with the configured contour method into context.Contours and records the ones
+ *  within the area limits in context.FilteredContourIndices. The contours are in the coordinates of the whole preprocessed image, whatever
+ *  region was preprocessed and whichever contour method is used.
+ */
+inline void FindContoursWithinLimits(const Parameters& parameters, PipelineContext& context) {
+
+	context.PrefilteredBlobCount = 0;
+
+	if (parameters.ContourMethod == CONTOUR_METHOD_BOUNDARY) {
+		FindMaskBoundaries(parameters, context);
+
+	} else if (parameters.ContourMethod == CONTOUR_METHOD_COMPONENTS) {
+		FindComponentBoundaries(parameters, context);
+
+	} else {
+		FindEdgeContours(parameters, context);
+	}
+
+	context.RejectedBlobCount = context.PrefilteredBlobCount + (int)(context.Contours.size() - context.FilteredContourIndices.size());
+}
+
+/**
+ * \brief Finds the most central contour within the area limits in the preprocessed region and stores it in context.ConeContour.
+ * \return The cone contour, which is empty if no contour was found.
+ */
+inline const vector<Point2i>& FindConeContour(const Parameters& parameters, PipelineContext& context) {
+
+	FindContoursWithinLimits(parameters, context);
+
+	const int coneContourIndex = MostCentralContour(context.ContourStatistics, context.FilteredContourIndices, parameters.CameraResolution);
+
+	if (coneContourIndex < 0) {
+		context.ConeContour.clear();
+		context.ConeStats = ContourStats();
+
+	} else {
+		context.ConeContour = context.Contours[coneContourIndex];
+		context.ConeStats = context.ContourStatistics[coneContourIndex];
+	}
+
+	return context.ConeContour;
+}
+
+/**
+ * \brief The smallest squared distance from the centroid at which a contour point is part of a corner. A point is part of a corner if its
+ *  distance is not below 0.85 times the distance to the tip, and the threshold is searched for with exactly that comparison, so comparing
+ *  squared distances against it gives the same result.
+ */
+inline int CornerSquaredDistanceThreshold(const int tipSquaredDistance) {
+
+	const double cornerDistance = sqrt(tipSquaredDistance) * 0.85;
+
+	int threshold = (int)ceil(cornerDistance * cornerDistance);
+
+	while (threshold > 0 && !(sqrt(threshold - 1) < cornerDistance)) {
+		threshold--;
+	}
+
+	while (sqrt(threshold) < cornerDistance) {
+		threshold++;
+	}
+
+	return threshold;
+}
+
+/**
+ * \brief Groups the contour points that are far enough from the centroid to be part of a corner into runs of nearby points.
+ * \param squaredDistances The squared distance of every contour point to the centroid.
+ * \param tipSquaredDistance The squared distance of the farthest point to the centroid.
+ * \param cornerIndices Receives the indices of the contour points far enough from the centroid.
+ */
+inline void GetConeCornerGroups(const vector<Point2i>& coneContour, const vector<int>& squaredDistances, const int tipSquaredDistance,
+	vector<int>& cornerIndices, CornerGroupList& cornerGroups) {
+
+	RadialFilter(squaredDistances, CornerSquaredDistanceThreshold(tipSquaredDistance), cornerIndices);
+
+	cornerGroups.Clear();
+
+	for (const int i : cornerIndices) {
+
+		const Point2i point = coneContour[i];
+
+		if (cornerGroups.GetGroupCount() == 0) {
+			cornerGroups.StartGroup(point);
+			continue;
+		}
+
+		const Point2i previousPoint = cornerGroups.GetPoints().back();
+		const int squaredDistanceToPreviousPoint = SquaredDistanceBetweenPoints(point, previousPoint);
+
+		const bool continuationOfPreviousCorner = coneContour[i - 1] == previousPoint;
+		const bool notTooFarFromPreviousPoint = squaredDistanceToPreviousPoint < 15 * 15;
+		const bool closeToPreviousPoint = squaredDistanceToPreviousPoint < 6 * 6;
+
+		if ((continuationOfPreviousCorner && notTooFarFromPreviousPoint) || closeToPreviousPoint) {
+			cornerGroups.AddToLastGroup(point);
+
+		} else {
+			cornerGroups.StartGroup(point);
+		}
+	}
+
+	if (cornerGroups.GetGroupCount() < 2) {
+		return;
+	}
+
+	if (cornerGroups.GetPoints().back() == coneContour.back() && *cornerGroups.GroupBegin(0) == coneContour.front()) {
+		cornerGroups.MergeLastGroupIntoFirst();
+	}
+}
+
+inline vector<Point2i> GetHighestInEachCornerGroup(const CornerGroupList& cornerGroups,
+	Point2i& highestPointInHighestCorner, Point2i& highestPointInSecondHighestCorner) {
+
+	vector<Point2i> northMostInEachCornerGroup{};
+
+	for (int group = 0; group < cornerGroups.GetGroupCount(); group++) {
+
+		const Point2i* point = cornerGroups.GroupBegin(group);
+		Point2i northMost = *point;
+
+		for (; point != cornerGroups.GroupEnd(group); point++) {
+
+			if (point->y < northMost.y) {
+				northMost = *point;
+			}
+		}
+
+		northMostInEachCornerGroup.push_back(northMost);
+	}
+
+	highestPointInHighestCorner = northMostInEachCornerGroup[0].y < northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
+	highestPointInSecondHighestCorner = northMostInEachCornerGroup[0].y > northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
+	for (int i = 2; i < northMostInEachCornerGroup.size(); i++) {
+
+		if (northMostInEachCornerGroup[i].y < highestPointInSecondHighestCorner.y) {
+			highestPointInSecondHighestCorner = northMostInEachCornerGroup[i];
+		}
+
+		if (northMostInEachCornerGroup[i].y < highestPointInHighestCorner.y) {
+			const Point2i temp = highestPointInSecondHighestCorner;
+			highestPointInSecondHighestCorner = highestPointInHighestCorner;
+			highestPointInHighestCorner = temp;
+		}
+	}
+
+	return northMostInEachCornerGroup;
+}
+
+inline Point2i AdjustTipFromCornerPoints(const CornerGroupList& cornerGroups, const Point2i currentTipPosition) {
+
+	const int groupCount = cornerGroups.GetGroupCount();
+
+	if (groupCount < 4) {
+		return currentTipPosition;
+	}
+
+	if (groupCount == 4) {
+
+		Point2i highestPoint;
+		Point2i secondHighestPoint;
+		GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondHighestPoint);
+
+		if (highestPoint.y - secondHighestPoint.y < -5) {
+			return highestPoint;
+		}
+
+		return Point2i((highestPoint.x + secondHighestPoint.x) / 2, (highestPoint.y + secondHighestPoint.y) / 2);
+	}
+
+	if (groupCount == 5) {
+
+		Point2i highestPoint = AveragePointInGroup(cornerGroups.GroupBegin(0), cornerGroups.GroupEnd(0));
+
+		for (int group = 1; group < groupCount; group++) {
+
+			const Point2i point = AveragePointInGroup(cornerGroups.GroupBegin(group), cornerGroups.GroupEnd(group));
+
+			if (point.y < highestPoint.y) {
+				highestPoint = point;
+			}
+		}
+
+		return highestPoint;
+	}
+
+	Point2i highestPoint;
+	Point2i secondNorthMost;
+	GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondNorthMost);
+
+	if (highestPoint.y - secondNorthMost.y < -5) {
+		return highestPoint;
+	}
+
+	double sumX = 0;
+	int numberOfPoints = 0;
+
+	for (const Point2i point : cornerGroups.GetPoints()) {
+		numberOfPoints++;
+		sumX += point.x;
+	}
+
+	return Point2i(sumX / numberOfPoints, highestPoint.y);
+}
+
+/**
+ * \brief The displacement of a camera position from the robot center, from the ground lookup table if GroundLookup is set, which must
+ *  have been built for the parameters, as PipelineTables does.
+ */
+inline Point2d CalculateGroundPosition(const Point2i cameraCoordinate, const Parameters& parameters, const GroundLookupTable& groundTable) {
+
+	if (parameters.GroundLookup != 0) {
+		return groundTable.Lookup(cameraCoordinate);
+	}
+
+	return CalculateObjectDisplacement(cameraCoordinate, parameters.CameraResolution, parameters.CameraFov, parameters.CameraOffset,
+		parameters.CameraAngle);
+}
+
+/**
+ * \brief Computes the details of a cone contour. Only reads the parameters and the ground table and only writes the buffers passed to it,
+ *  so the details of several contours can be computed in parallel.
+ * \param groundTable Must have been built for the parameters if GroundLookup is set.
+ * \param cornerGroups Receives the corner groups of the contour.
+ */
+inline void ComputeContourDetails(const vector<Point2i>& contour, const ContourStats& stats, const Parameters& parameters,
+	const GroundLookupTable& groundTable, vector<int>& squaredDistances, vector<int>& cornerIndices, CornerGroupList& cornerGroups,
+	ConeDetails* output) {
+
+	const Point2i centroid = stats.GetCentroid();
+	const int farthestPointIndex = FarthestPointIndex(contour, centroid, squaredDistances);
+	Point2i farthestPoint = contour[farthestPointIndex];
+
+	GetConeCornerGroups(contour, squaredDistances, squaredDistances[farthestPointIndex], cornerIndices, cornerGroups);
+	farthestPoint = AdjustTipFromCornerPoints(cornerGroups, farthestPoint);
+
+	const Point2d centroidPosition = CalculateGroundPosition(centroid, parameters, groundTable);
+	const Point2d tipPosition = CalculateGroundPosition(farthestPoint, parameters, groundTable);
+
+	const double coneAngle = CalculateConeAngle(centroidPosition, tipPosition);
+
+	const double adjustedConeAngle = ApplyConeTippedErrorCorrection(coneAngle, centroid, parameters.CameraAngle, parameters.CameraResolution, parameters.CameraFov);
+
+	*output = ConeDetails(centroidPosition, tipPosition, centroid, farthestPoint, adjustedConeAngle);
+}
+
+/**
+ * \brief Computes the details of the cone in context.ConeContour, whose stats FindConeContour left in context.ConeStats. The corner groups
+ *  are left in context.CornerGroups.
+ * \return False if no cone contour was found.
+ */
+inline bool ComputeConeDetails(const Parameters& parameters, PipelineContext& context, ConeDetails* output) {
+
+	if (context.ConeContour.empty()) {
+		context.CornerGroups.Clear();
+		return false;
+	}
+
+	ComputeContourDetails(context.ConeContour, context.ConeStats, parameters, context.Tables.GroundTable, context.SquaredDistances,
+		context.CornerIndices, context.CornerGroups, output);
+
+	return true;
+}
\ No newline at end of file
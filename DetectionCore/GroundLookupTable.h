@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Parameters.h"
+#include "Trigonometry.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Maps every pixel of the camera image, border included, to its displacement from the robot center on the ground, so
+ *  CalculateObjectDisplacement does not have to be evaluated per point. The table holds the exact result for every whole pixel and is
+ *  interpolated bilinearly between them.
+ */
+class GroundLookupTable {
+
+		vector<Point2d> Table;
+		int Columns = 0;
+		int Rows = 0;
+
+		Point2i BuiltResolution = Point2i(-1, -1);
+		Point2d BuiltFov;
+		Point3d BuiltOffset;
+		Point2d BuiltAngle;
+
+		void Build(const Parameters& parameters) {
+
+			Columns = parameters.CameraResolution.x;
+			Rows = parameters.CameraResolution.y;
+			Table.resize((size_t)Columns * Rows);
+
+			parallel_for_(Range(0, Rows), [&](const Range& range) {
+
+				for (int row = range.start; row < range.end; row++) {
+					for (int column = 0; column < Columns; column++) {
+
+						Table[(size_t)row * Columns + column] = CalculateObjectDisplacement(Point2i(column, row), parameters.CameraResolution,
+							parameters.CameraFov, parameters.CameraOffset, parameters.CameraAngle);
+					}
+				}
+			});
+
+			BuiltResolution = parameters.CameraResolution;
+			BuiltFov = parameters.CameraFov;
+			BuiltOffset = parameters.CameraOffset;
+			BuiltAngle = parameters.CameraAngle;
+		}
+
+	public:
+
+		/**
+		 * \brief Rebuilds the table if the camera resolution, field of view, offset or angle changed since it was built.
+		 * \return True if the table was rebuilt.
+		 */
+		bool Update(const Parameters& parameters) {
+
+			const bool changed = parameters.CameraResolution != BuiltResolution || parameters.CameraFov != BuiltFov ||
+				parameters.CameraOffset != BuiltOffset || parameters.CameraAngle != BuiltAngle;
+
+			if (changed) {
+				Build(parameters);
+			}
+
+			return changed;
+		}
+
+		/**
+		 * \brief The displacement of a whole pixel, which is the same value CalculateObjectDisplacement returns for it. Coordinates outside
+		 *  the image are clamped to its edge.
+		 */
+		Point2d Lookup(const Point2i cameraCoordinate) const {
+
+			const int column = min(max(cameraCoordinate.x, 0), Columns - 1);
+			const int row = min(max(cameraCoordinate.y, 0), Rows - 1);
+
+			return Table[(size_t)row * Columns + column];
+		}
+
+		/**
+		 * \brief The displacement of a sub-pixel position, interpolated bilinearly between the four surrounding pixels. Coordinates outside
+		 *  the image are clamped to its edge.
+		 */
+		Point2d Lookup(const Point2d cameraCoordinate) const {
+
+			const double x = min(max(cameraCoordinate.x, 0.0), Columns - 1.0);
+			const double y = min(max(cameraCoordinate.y, 0.0), Rows - 1.0);
+
+			const int left = min((int)x, Columns - 2);
+			const int top = min((int)y, Rows - 2);
+			const double fractionX = x - left;
+			const double fractionY = y - top;
+
+			const Point2d* topRow = &Table[(size_t)top * Columns + left];
+			const Point2d* bottomRow = topRow + Columns;
+
+			const Point2d topValue = topRow[0] * (1 - fractionX) + topRow[1] * fractionX;
+			const Point2d bottomValue = bottomRow[0] * (1 - fractionX) + bottomRow[1] * fractionX;
+
+			return topValue * (1 - fractionY) + bottomValue * fractionY;
+		}
+
+		/**
+		 * \brief Looks up the displacement of every point, for converting whole contours.
+		 */
+		void LookupAll(const vector<Point2i>& cameraCoordinates, vector<Point2d>& displacements) const {
+
+			displacements.resize(cameraCoordinates.size());
+
+			for (size_t i = 0; i < cameraCoordinates.size(); i++) {
+				displacements[i] = Lookup(cameraCoordinates[i]);
+			}
+		}
+
+};
\ No newline at end of file
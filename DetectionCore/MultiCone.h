@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "ConeDetails.h"
+#include "Detection.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "PipelinePolicies.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Computes the details of every contour within the area limits that FindContoursWithinLimits found, in parallel, and leaves them in
+ *  cones sorted by their distance from the robot center, nearest first. When there are more than MaxCones contours only the largest ones
+ *  are computed, which bounds the time a frame full of orange can take. The contours computed are left in context.CandidateIndices, with
+ *  their details and corner groups at the same positions in context.CandidateDetails and context.CandidateBuffers, and the position of
+ *  each cone in them in context.CandidateOrder.
+ * \return The number of cones found.
+ */
+inline int ComputeAllConeDetails(const Parameters& parameters, PipelineContext& context, vector<ConeDetails>& cones) {
+
+	vector<int>& indices = context.CandidateIndices;
+	indices.assign(context.FilteredContourIndices.begin(), context.FilteredContourIndices.end());
+
+	const int count = min((int)indices.size(), max(parameters.MaxCones, 0));
+
+	if (count < (int)indices.size()) {
+
+		nth_element(indices.begin(), indices.begin() + count, indices.end(), [&](const int first, const int second) {
+			return context.ContourStatistics[first].Area > context.ContourStatistics[second].Area;
+		});
+
+		indices.resize(count);
+	}
+
+	if ((int)context.CandidateBuffers.size() < count) {
+		context.CandidateBuffers.resize(count);
+	}
+
+	context.CandidateDetails.resize(count);
+
+	parallel_for_(Range(0, count), [&](const Range& range) {
+
+		for (int i = range.start; i < range.end; i++) {
+
+			const int index = indices[i];
+			ContourDetailBuffers& buffers = context.CandidateBuffers[i];
+
+			ComputeContourDetails(context.Contours[index], context.ContourStatistics[index], parameters, context.Tables.GroundTable,
+				buffers.SquaredDistances, buffers.CornerIndices, buffers.CornerGroups, &context.CandidateDetails[i]);
+		}
+	});
+
+	vector<int>& order = context.CandidateOrder;
+	order.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		order[i] = i;
+	}
+
+	sort(order.begin(), order.end(), [&](const int first, const int second) {
+		return norm(context.CandidateDetails[first].GetCentroidPosition()) < norm(context.CandidateDetails[second].GetCentroidPosition());
+	});
+
+	cones.clear();
+
+	for (const int i : order) {
+		cones.push_back(context.CandidateDetails[i]);
+	}
+
+	return count;
+}
+
+/**
+ * \brief Runs the stages that follow the preprocessing on the whole image already preprocessed in the context, and computes the details
+ *  of every cone in it.
+ * \return The number of cones found.
+ */
+template <typename DebugPolicy>
+inline int FindAllCones(const Parameters& parameters, PipelineContext& context, DebugPolicy& debug, vector<ConeDetails>& cones) {
+
+	debug.BeginStage(PIPELINE_STAGE_CONTOURS);
+	FindContoursWithinLimits(parameters, context);
+	debug.EndStage(PIPELINE_STAGE_CONTOURS, context);
+
+	// there is no single cone, so nothing is left from a previous single cone frame
+	context.ConeContour.clear();
+	context.ConeStats = ContourStats();
+	context.CornerGroups.Clear();
+
+	debug.BeginStage(PIPELINE_STAGE_DETAILS);
+	const int count = ComputeAllConeDetails(parameters, context, cones);
+	debug.EndStage(PIPELINE_STAGE_DETAILS, context);
+
+	return count;
+}
+
+/**
+ * \brief Runs the whole pipeline on the whole image and computes the details of every cone in it. Region tracking and the coarse to fine
+ *  search follow a single cone, so they are not used.
+ * \return The number of cones found.
+ */
+template <typename DebugPolicy>
+inline int DetectAllCones(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, DebugPolicy& debug,
+	vector<ConeDetails>& cones) {
+
+	debug.BeginStage(PIPELINE_STAGE_PREPROCESS);
+	PreProcessImage(sourceImage, parameters, context);
+	debug.EndStage(PIPELINE_STAGE_PREPROCESS, context);
+
+	return FindAllCones(parameters, context, debug, cones);
+}
+
+/**
+ * \brief Runs the whole pipeline on the whole image and computes the details of every cone in it. Region tracking and the coarse to fine
+ *  search follow a single cone, so they are not used.
+ * \return The number of cones found.
+ */
+inline int DetectAllCones(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, vector<ConeDetails>& cones) {
+
+	NoDebug debug;
+	return DetectAllCones(sourceImage, parameters, context, debug, cones);
+}
\ No newline at end of file
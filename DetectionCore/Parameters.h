@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "Trigonometry.h"
+
+using namespace cv;
+
+
+
+const int COLOR_MASK_INRANGE = 0;
+const int COLOR_MASK_FUSED = 1;
+const int COLOR_MASK_LOOKUP = 2;
+
+const int CONTOUR_METHOD_EDGES = 0;
+const int CONTOUR_METHOD_BOUNDARY = 1;
+const int CONTOUR_METHOD_COMPONENTS = 2;
+
+class Parameters {
+
+	public:
+
+		// the defaults are tuned for the calibration videos, the robot overrides the masks for its camera in RobotParameters
+
+		int CameraId = 1;
+		int WindowWidth = 2039;// 1912;
+		int WindowHeight = 1080;// 1009;
+
+		int MiddleHueMin = 25;
+		int MiddleHueMax = 35;
+		int MiddleSaturationMin = 21;
+		int MiddleSaturationMax = 255;
+		int MiddleValueMin = 190;
+		int MiddleValueMax = 255;
+		int MiddleMaskWeight = 100;
+
+		int HighlightHueMin = 0;
+		int HighlightHueMax = 170;
+		int HighlightSaturationMin = 0;
+		int HighlightSaturationMax = 46;
+		int HighlightValueMin = 210;
+		int HighlightValueMax = 255;
+		int HighlightMaskWeight = 100;
+
+		int LowLightHueMin = 4;
+		int LowLightHueMax = 35;
+		int LowLightSaturationMin = 130;
+		int LowLightSaturationMax = 255;
+		int LowLightValueMin = 104;
+		int LowLightValueMax = 255;
+		int LowLightMaskWeight = 100;
+										
+		int ColorMaskMode = COLOR_MASK_FUSED;
+
+		int MaskThreshold = 120;
+		int TotalMaskBlur = 7;
+
+		int CannyThreshold1 = 100;
+		int CannyThreshold2 = 150;
+								
+		int ContourDilation = 3;
+		int ContourMethod = CONTOUR_METHOD_EDGES; // 1 traces the opened digitized mask instead of its dilated edges, 2 also skips the mask blobs that cannot be within the area limits
+								
+		int MinContourArea = 2750;
+		int MaxContourArea = 9250;
+
+		int RoiTracking = 0; // 1 only processes a padded region around the cone found in the previous frame
+		int RoiPadding = 40;
+		int RoiFullScanInterval = 30;
+
+		int PyramidLevels = 0; // 1 or 2 first searches for cone candidates at half or quarter resolution, 0 processes the whole image
+		int PyramidPadding = 16;
+
+		int GroundLookup = 0; // 1 converts camera positions to ground positions with a table built once instead of the trigonometry
+
+		int MultiCone = 0; // 1 computes the details of every contour within the area limits instead of only the most central one
+		int MaxCones = 4; // the most contours multi cone mode computes the details of, the largest ones are kept
+
+		int TemporalFilter = 0; // 1 smooths the cone details from frame to frame and moves the ROI along with the cone, not in multi cone mode
+		int FilterAlpha = 50; // percent of the difference to the predicted position taken from each measurement, lower is smoother
+		int FilterBeta = 10; // percent of that difference taken into the estimated speed
+		int PredictionLatency = 0; // milliseconds after the capture time the filtered cone is predicted for
+		int FilterTimeout = 250; // milliseconds without a cone after which the filter forgets it
+
+		int PipelineDepth = 0; // 0 runs every stage serially on the main thread, above 0 the robot runs the staged pipeline with this many frames per queue, the robot's --depth overrides it
+
+		const Point2i CameraResolution = Point2i(640, 480) + Point2i(2, 2); // plus 2 to each for the borders
+		const Point2d CameraFov = Point2d(54.18l / 180.0l * PI, 39.93l / 180.0l * PI); // 3.6mm ELP
+		//const Point2d CameraFov = Point2d(48.5l / 180.0l * PI, 36.0l / 180.0l * PI); // Microsoft Lifecam HD 3000
+		
+		Point3d CameraOffset = Point3d(0, -6.75, 52);
+		Point2d CameraAngle = Point2d(0.0l / 180.0l * PI, -60.0l / 180.01 * PI);
+
+};
\ No newline at end of file
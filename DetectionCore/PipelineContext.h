@@ -0,0 +1,212 @@
+﻿#pragma once
+
+#include <array>
+#include <iostream>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "ColorMasks.h"
+#include "ConeDetails.h"
+#include "Contours.h"
+#include "CornerGroups.h"
+#include "GroundLookupTable.h"
+#include "Parameters.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief A view of the top left corner of a buffer that OpenCV treats as an image of its own. The filters read the pixels of the parent
+ *  image past the right and bottom edges of an ordinary view instead of extrapolating the border, and in the context's buffers those are
+ *  left over from earlier frames, so a region would be blurred, opened and bordered differently depending on what was processed before.
+ *  The view does not keep the buffer alive.
+ */
+inline Mat BufferCorner(const Mat& buffer, const Size size) {
+	return Mat(size, buffer.type(), buffer.data, buffer.step);
+}
+
+/**
+ * \brief The buffers for computing the details of one contour. Multi cone mode keeps one per candidate so the candidates can be computed
+ *  in parallel.
+ */
+struct ContourDetailBuffers {
+
+	vector<int> SquaredDistances;
+	vector<int> CornerIndices;
+	CornerGroupList CornerGroups;
+};
+
+/**
+ * \brief The tables the pipeline computes from the parameters instead of from a frame. They are only read while detecting, so every context
+ *  of a pipeline shares one instance, which is updated between frames by whoever owns the parameters.
+ */
+class PipelineTables {
+
+	public:
+
+		MergedMaskValues MergedValues;
+		ColorMaskLookupTable LookupTable;
+		GroundLookupTable GroundTable;
+
+		/**
+		 * \brief Builds every table the parameters use.
+		 */
+		PipelineTables(const Parameters& parameters) {
+			Update(parameters);
+		}
+
+		PipelineTables(const PipelineTables&) = delete;
+		PipelineTables& operator=(const PipelineTables&) = delete;
+
+		/**
+		 * \brief Rebuilds the tables whose parameters changed since they were last built. The color mask lookup table is only built while
+		 *  the lookup color mask mode is selected and the ground table while GroundLookup is set, since building them takes a while. It must
+		 *  not run while a context sharing the tables is detecting.
+		 */
+		void Update(const Parameters& parameters) {
+
+			MergedValues.Update(parameters);
+
+			if (parameters.ColorMaskMode == COLOR_MASK_LOOKUP && LookupTable.Update(parameters)) {
+				cout << "Rebuilt the color mask lookup table, " << LookupTable.GetMismatchedColorFraction() * 100 << "% of colors differ from the exact mask." << endl;
+			}
+
+			if (parameters.GroundLookup != 0) {
+				GroundTable.Update(parameters);
+			}
+		}
+
+};
+
+/**
+ * \brief Owns every intermediate image and contour buffer of the detection pipeline so they are allocated once at startup and reused for
+ *  every frame instead of being reallocated by each stage. The tables are shared and only read.
+ */
+class PipelineContext {
+
+		int DilationKernelSize = 0;
+		Mat DilationKernel;
+
+		// the storage of the images allocated by the constructor, to check that no stage reallocated them
+		array<const uchar*, 13> AllocatedBufferData;
+
+		array<const uchar*, 13> GetBufferData() const {
+
+			return { ImageHsv.data, MiddleMask.data, HighlightMask.data, LowLightMask.data, MasksMerged.data, MaskBlurred.data,
+				MasksMergedDigitized.data, Edges.data, ContoursDilated.data, PreProcessedImage.data, CoarseImage.data, ComponentLabels.data,
+				ComponentMask.data };
+		}
+
+	public:
+
+		Mat ImageHsv;
+		Mat MiddleMask, HighlightMask, LowLightMask;
+		Mat MasksMerged, MaskBlurred, MasksMergedDigitized;
+		Mat Edges, ContoursDilated;
+		Mat PreProcessedImage;
+		Mat CoarseImage;
+		Mat ComponentLabels, ComponentMask, ComponentStats, ComponentCentroids;
+
+		// the part of the source image the buffers hold, in their top left corner
+		Rect Region;
+
+		vector<vector<Point2i>> Contours;
+		vector<Vec4i> Hierarchy;
+		vector<ContourStats> ContourStatistics;
+		vector<int> FilteredContourIndices;
+		vector<Point2i> ConeContour;
+		ContourStats ConeStats;
+		vector<int> SquaredDistances;
+		vector<int> CornerIndices;
+		CornerGroupList CornerGroups;
+		vector<vector<Point2i>> CoarseContours;
+		vector<Rect> Candidates;
+		vector<vector<Point2i>> ComponentContours;
+
+		// the contours multi cone mode computes the details of, with the buffers and the details of each, and their order by distance
+		vector<int> CandidateIndices;
+		vector<ContourDetailBuffers> CandidateBuffers;
+		vector<ConeDetails> CandidateDetails;
+		vector<int> CandidateOrder;
+
+		// the blobs or contours of the last FindConeContour call that were outside the area limits, and how many of them the component
+		// prefilter rejected without tracing them
+		int RejectedBlobCount = 0;
+		int PrefilteredBlobCount = 0;
+
+		const PipelineTables& Tables;
+
+		/**
+		 * \param cameraResolution The resolution of the preprocessed image, which includes the 1 pixel border on each side.
+		 * \param tables Has to outlive the context.
+		 */
+		PipelineContext(const Point2i cameraResolution, const PipelineTables& tables) : Tables(tables) {
+
+			const int rows = cameraResolution.y - 2;
+			const int columns = cameraResolution.x - 2;
+
+			ImageHsv.create(rows, columns, CV_8UC3);
+			MiddleMask.create(rows, columns, CV_8UC1);
+			HighlightMask.create(rows, columns, CV_8UC1);
+			LowLightMask.create(rows, columns, CV_8UC1);
+			MasksMerged.create(rows, columns, CV_8UC1);
+			MaskBlurred.create(rows, columns, CV_8UC1);
+			MasksMergedDigitized.create(rows, columns, CV_8UC1);
+			Edges.create(rows, columns, CV_8UC1);
+			ContoursDilated.create(rows, columns, CV_8UC1);
+			PreProcessedImage.create(cameraResolution.y, cameraResolution.x, CV_8UC1);
+			CoarseImage.create(rows / 2, columns / 2, CV_8UC3);
+			ComponentLabels.create(rows, columns, CV_32SC1);
+			ComponentMask.create(rows, columns, CV_8UC1);
+
+			AllocatedBufferData = GetBufferData();
+
+			Region = Rect(0, 0, columns, rows);
+
+			Contours.reserve(256);
+			Hierarchy.reserve(256);
+			ContourStatistics.reserve(256);
+			FilteredContourIndices.reserve(256);
+			ConeContour.reserve(4096);
+			SquaredDistances.reserve(4096);
+			CornerIndices.reserve(4096);
+			CoarseContours.reserve(256);
+			Candidates.reserve(16);
+			ComponentContours.reserve(4);
+			CandidateIndices.reserve(256);
+			CandidateBuffers.reserve(16);
+			CandidateDetails.reserve(16);
+			CandidateOrder.reserve(16);
+		}
+
+		/**
+		 * \brief Whether every image allocated by the constructor still has its original storage. The stages write into views of these
+		 *  images, so a stage producing a different size or type reallocates the view and not the image, and this stays true. It only turns
+		 *  false when a stage replaces an image, which would allocate on every frame from then on. The scratch buffers OpenCV allocates
+		 *  inside its functions and the vectors growing past their reserved size are not covered.
+		 */
+		bool BuffersUnchanged() const {
+			return GetBufferData() == AllocatedBufferData;
+		}
+
+		/**
+		 * \brief The square dilation kernel of the specified size, only rebuilt when the size changes.
+		 */
+		const Mat& GetDilationKernel(int kernelSize) {
+
+			if (kernelSize % 2 == 0) {
+				kernelSize++;
+			}
+
+			if (kernelSize != DilationKernelSize) {
+				DilationKernel = getStructuringElement(MORPH_RECT, Size(kernelSize, kernelSize));
+				DilationKernelSize = kernelSize;
+			}
+
+			return DilationKernel;
+		}
+
+};
\ No newline at end of file
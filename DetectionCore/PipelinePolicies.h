@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <chrono>
+
+#include <opencv2/core.hpp>
+
+#include "PipelineContext.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+const int PIPELINE_STAGE_COARSE = 0;
+const int PIPELINE_STAGE_PREPROCESS = 1;
+const int PIPELINE_STAGE_CONTOURS = 2;
+const int PIPELINE_STAGE_DETAILS = 3;
+const int PIPELINE_STAGE_COUNT = 4;
+
+const char* const PIPELINE_STAGE_NAMES[PIPELINE_STAGE_COUNT] = { "Coarse", "Pre-Process", "Contours", "Details" };
+
+/**
+ * \brief The debug policy of the production pipeline. Every hook is empty, so a pipeline specialized on it compiles them all away.
+ */
+struct NoDebug {
+
+	static const bool IsTimed = false;
+	static const bool CapturesStages = false;
+
+	void BeginFrame() {}
+	void BeginStage(const int stage) {}
+	void EndStage(const int stage, const PipelineContext& context) {}
+	void EndFrame() {}
+};
+
+/**
+ * \brief Times each stage of the pipeline and the whole frame. A stage that runs more than once in a frame, like when the search region
+ *  loses the cone or the coarse search has several candidates, is timed as the sum of its runs.
+ */
+class Timing {
+
+		time_point<steady_clock> FrameStartTime, StageStartTime;
+		double StageMilliseconds[PIPELINE_STAGE_COUNT] = {};
+		int StageRunCounts[PIPELINE_STAGE_COUNT] = {};
+		double FrameMilliseconds = 0;
+
+	public:
+
+		static const bool IsTimed = true;
+		static const bool CapturesStages = false;
+
+		void BeginFrame() {
+
+			for (int stage = 0; stage < PIPELINE_STAGE_COUNT; stage++) {
+				StageMilliseconds[stage] = 0;
+				StageRunCounts[stage] = 0;
+			}
+
+			FrameStartTime = steady_clock::now();
+		}
+
+		void BeginStage(const int stage) {
+			StageStartTime = steady_clock::now();
+		}
+
+		void EndStage(const int stage, const PipelineContext& context) {
+			StageMilliseconds[stage] += duration<double, milli>(steady_clock::now() - StageStartTime).count();
+			StageRunCounts[stage]++;
+		}
+
+		void EndFrame() {
+			FrameMilliseconds = duration<double, milli>(steady_clock::now() - FrameStartTime).count();
+		}
+
+		double GetStageMilliseconds(const int stage) const {
+			return StageMilliseconds[stage];
+		}
+
+		int GetStageRunCount(const int stage) const {
+			return StageRunCounts[stage];
+		}
+
+		double GetFrameMilliseconds() const {
+			return FrameMilliseconds;
+		}
+
+};
+
+/**
+ * \brief Times the pipeline like Timing, and also keeps a copy of the images of the pre-processing stage, so they can be shown after the
+ *  frame, or while the context is already being reused for the next one. The copies are made after the stage is timed.
+ */
+class CaptureStages : public Timing {
+
+	public:
+
+		static const bool CapturesStages = true;
+
+		Mat MiddleMask, HighlightMask, LowLightMask;
+		Mat MasksMerged, MaskBlurred, MasksMergedDigitized;
+		Mat PreProcessedImage;
+
+		void EndStage(const int stage, const PipelineContext& context) {
+
+			Timing::EndStage(stage, context);
+
+			if (stage != PIPELINE_STAGE_PREPROCESS) {
+				return;
+			}
+
+			context.MiddleMask.copyTo(MiddleMask);
+			context.HighlightMask.copyTo(HighlightMask);
+			context.LowLightMask.copyTo(LowLightMask);
+			context.MasksMerged.copyTo(MasksMerged);
+			context.MaskBlurred.copyTo(MaskBlurred);
+			context.MasksMergedDigitized.copyTo(MasksMergedDigitized);
+			context.PreProcessedImage.copyTo(PreProcessedImage);
+		}
+
+};
\ No newline at end of file
@@ -23,6 +23,14 @@ inline double DistanceBetweenPoints(const Point2i a, const Point2i b) {
 	//return sqrt(( (a.x - b.x) * (a.x - b.x)) + ((a.y - b.y) * (a.y - b.x)));
 }
 
+inline int SquaredDistanceBetweenPoints(const Point2i a, const Point2i b) {
+
+	const int deltaX = a.x - b.x;
+	const int deltaY = a.y - b.y;
+
+	return deltaX * deltaX + deltaY * deltaY;
+}
+
 inline Point FarthestPoint(const vector<Point2i>& points, const Point2i basePoint) {
 
 	Point2i farthestPoint = points[0];
@@ -41,15 +49,21 @@ inline Point FarthestPoint(const vector<Point2i>& points, const Point2i basePoin
 	return farthestPoint;
 }
 
-inline Point2i AveragePointInGroup(const vector<Point2i>& group) {
+inline Point2i AveragePointInGroup(const Point2i* begin, const Point2i* end) {
 
 	double sumX = 0, sumY = 0;
 
-	for (const Point2i point : group) {
+	for (const Point2i* point = begin; point != end; point++) {
 
-		sumX += point.x;
-		sumY += point.y;
+		sumX += point->x;
+		sumY += point->y;
 	}
 
-	return Point2i(sumX / group.size(), sumY / group.size());
+	const size_t count = end - begin;
+
+	return Point2i(sumX / count, sumY / count);
+}
+
+inline Point2i AveragePointInGroup(const vector<Point2i>& group) {
+	return AveragePointInGroup(group.data(), group.data() + group.size());
 }
\ No newline at end of file
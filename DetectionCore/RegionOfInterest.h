@@ -0,0 +1,162 @@
+﻿#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "CoarseToFine.h"
+#include "ConeDetails.h"
+#include "Detection.h"
+#include "Parameters.h"
+#include "PipelineContext.h"
+#include "PipelinePolicies.h"
+
+using namespace cv;
+using namespace std;
+
+
+
+/**
+ * \brief Tracks the area of the image the cone was last found in, so only a padded region around it needs to be processed. The whole
+ *  image is scanned when there is no cone to track and every RoiFullScanInterval frames, so new cones are still picked up.
+ */
+class RegionTracker {
+
+		bool HasTarget = false;
+		Rect TargetBounds;
+		int FramesSinceFullScan = 0;
+
+		long long RegionFrameCount = 0;
+		long long RegionHitCount = 0;
+		long long FullScanCount = 0;
+
+	public:
+
+		/**
+		 * \brief The region of the source image to process next, which is the whole image when not tracking.
+		 * \param predictedMotion How far the cone is expected to have moved in the image since it was last found, the region is moved along.
+		 */
+		Rect NextRegion(const Parameters& parameters, const Size imageSize, const Point2i predictedMotion) const {
+
+			const Rect wholeImage = Rect(Point2i(0, 0), imageSize);
+
+			if (parameters.RoiTracking == 0 || !HasTarget || FramesSinceFullScan >= parameters.RoiFullScanInterval) {
+				return wholeImage;
+			}
+
+			const int padding = parameters.RoiPadding;
+			const Rect region = Rect(TargetBounds.x + predictedMotion.x - padding, TargetBounds.y + predictedMotion.y - padding,
+				TargetBounds.width + 2 * padding, TargetBounds.height + 2 * padding);
+
+			return region & wholeImage;
+		}
+
+		Rect NextRegion(const Parameters& parameters, const Size imageSize) const {
+			return NextRegion(parameters, imageSize, Point2i(0, 0));
+		}
+
+		/**
+		 * \brief Remembers where the cone was found in the processed region.
+		 * \param region The region that was processed.
+		 * \param imageSize The size of the whole source image.
+		 * \param coneBounds The bounding box of the cone contour in the coordinates of the preprocessed image, which has a 1 pixel border.
+		 * \return True if the cone was lost inside a smaller region, in which case the whole image should be scanned.
+		 */
+		bool Update(const Rect& region, const Size imageSize, const bool coneFound, const Rect& coneBounds,
+			const ConeDetails& coneDetails) {
+
+			const bool wholeImage = region.size() == imageSize;
+
+			if (wholeImage) {
+				FullScanCount++;
+				FramesSinceFullScan = 0;
+
+			} else {
+				RegionFrameCount++;
+				FramesSinceFullScan++;
+
+				if (coneFound) {
+					RegionHitCount++;
+				}
+			}
+
+			HasTarget = coneFound;
+
+			if (coneFound) {
+				Rect bounds = coneBounds;
+				bounds |= Rect(coneDetails.GetCentroidCameraPosition(), Size(1, 1));
+				bounds |= Rect(coneDetails.GetTipCameraPosition(), Size(1, 1));
+
+				// back from preprocessed image coordinates to source image coordinates
+				TargetBounds = bounds - Point2i(1, 1);
+			}
+
+			return !coneFound && !wholeImage;
+		}
+
+		/**
+		 * \brief The fraction of the frames processed in a smaller region that found the cone there.
+		 */
+		double GetHitRate() const {
+			return RegionFrameCount == 0 ? 0 : (double)RegionHitCount / RegionFrameCount;
+		}
+
+		long long GetRegionFrameCount() const {
+			return RegionFrameCount;
+		}
+
+		long long GetFullScanCount() const {
+			return FullScanCount;
+		}
+
+};
+
+/**
+ * \brief Runs the whole pipeline on the region the tracker suggests, and again on the whole image if the cone was lost in it.
+ * \param predictedMotion How far the cone is expected to have moved in the image since it was last found.
+ * \return False if no cone was found.
+ */
+template <typename DebugPolicy>
+inline bool DetectConeTracked(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, RegionTracker& tracker,
+	const Point2i predictedMotion, DebugPolicy& debug, ConeDetails* output) {
+
+	const Rect wholeImage = Rect(0, 0, sourceImage.cols, sourceImage.rows);
+	const Rect region = tracker.NextRegion(parameters, sourceImage.size(), predictedMotion);
+
+	bool coneFound;
+
+	if (region == wholeImage) {
+		coneFound = DetectConeInWholeImage(sourceImage, parameters, context, debug, output);
+
+	} else {
+		coneFound = DetectConeInRegion(sourceImage, parameters, context, region, debug, output);
+	}
+
+	if (tracker.Update(region, sourceImage.size(), coneFound, context.ConeStats.Bounds, *output)) {
+		coneFound = DetectConeInWholeImage(sourceImage, parameters, context, debug, output);
+		tracker.Update(wholeImage, sourceImage.size(), coneFound, context.ConeStats.Bounds, *output);
+	}
+
+	return coneFound;
+}
+
+/**
+ * \brief Runs the whole pipeline on the region the tracker suggests, and again on the whole image if the cone was lost in it.
+ * \param predictedMotion How far the cone is expected to have moved in the image since it was last found.
+ * \return False if no cone was found.
+ */
+inline bool DetectConeTracked(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, RegionTracker& tracker,
+	const Point2i predictedMotion, ConeDetails* output) {
+
+	NoDebug debug;
+	return DetectConeTracked(sourceImage, parameters, context, tracker, predictedMotion, debug, output);
+}
+
+/**
+ * \brief Runs the whole pipeline on the region the tracker suggests, and again on the whole image if the cone was lost in it.
+ * \return False if no cone was found.
+ */
+inline bool DetectConeTracked(const Mat& sourceImage, const Parameters& parameters, PipelineContext& context, RegionTracker& tracker,
+	ConeDetails* output) {
+
+	return DetectConeTracked(sourceImage, parameters, context, tracker, Point2i(0, 0), output);
+}
\ No newline at end of file
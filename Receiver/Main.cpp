@@ -0,0 +1,142 @@
+// Receives the cone readings from the UDP or shared memory sink of the robot program running on the same machine and reports how long they
+// took to arrive.
+//
+// usage: Receiver --udp PORT [--count N]
+//        Receiver --shm NAME [--count N]
+//
+// Start the robot program with UDP_SINK or SHARED_MEMORY_SINK defined first, the shared memory only exists while it runs. The receiver
+// stops after N readings, 1000 by default, or after 5 seconds without one, and prints the latency from publishing and from capturing to
+// receiving, the readings the robot program skipped or coalesced, going by the gaps in the frame ids, and the readings lost on the way.
+// It uses POSIX sockets and shared memory, so it only builds outside of Visual Studio, with
+// g++ -O2 -std=c++14 Receiver/Main.cpp -o receiver $(pkg-config --cflags --libs opencv4) -lrt
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../Benchmark/LatencyStats.h"
+#include "../Robot/LocalSinks.h"
+#include "../Robot/ResultSink.h"
+
+using namespace std;
+using namespace std::chrono;
+
+
+
+const int RECEIVE_TIMEOUT_MILLISECONDS = 5000;
+
+void PrintLatencyRow(const string& name, LatencyStats& stats) {
+
+	cout << "  " << left << setw(20) << name << right << fixed << setprecision(3) << setw(10) << stats.GetMean() << setw(10)
+		<< stats.GetPercentile(50) << setw(10) << stats.GetPercentile(95) << setw(10) << stats.GetPercentile(99) << setw(10)
+		<< stats.GetMax() << endl;
+}
+
+int main(const int argc, char** argv) {
+
+	int port = 0;
+	string sharedMemoryName;
+	int count = 1000;
+
+	for (int i = 1; i < argc; i++) {
+
+		const string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--udp" && hasValue) {
+			port = stoi(argv[++i]);
+
+		} else if (argument == "--shm" && hasValue) {
+			sharedMemoryName = argv[++i];
+
+		} else if (argument == "--count" && hasValue) {
+			count = max(1, stoi(argv[++i]));
+
+		} else {
+			cerr << "Unknown argument " << argument << endl;
+			return 1;
+		}
+	}
+
+	if ((port > 0) == !sharedMemoryName.empty()) {
+		cerr << "Pass either --udp PORT or --shm NAME" << endl;
+		return 1;
+	}
+
+	unique_ptr<UdpReceiver> udpReceiver;
+	unique_ptr<SharedMemoryReader> sharedMemoryReader;
+
+	if (port > 0) {
+		udpReceiver.reset(new UdpReceiver(port, RECEIVE_TIMEOUT_MILLISECONDS));
+
+	} else {
+		sharedMemoryReader.reset(new SharedMemoryReader(sharedMemoryName));
+	}
+
+	if ((udpReceiver && !udpReceiver->IsValid()) || (sharedMemoryReader && !sharedMemoryReader->IsValid())) {
+		cerr << "Could not open " << (port > 0 ? "UDP port " + to_string(port) : sharedMemoryName) << endl;
+		return 1;
+	}
+
+	LatencyStats publishLatency, captureLatency, processingLatency;
+	double packet[PACKET_SIZE];
+	long long receivedCount = 0;
+	long long skippedCount = 0;
+	long long lastFrameId = -1;
+	long long conesFoundCount = 0;
+
+	while (receivedCount < count) {
+
+		bool received = false;
+
+		if (udpReceiver) {
+			received = udpReceiver->Receive(packet);
+
+		} else {
+
+			const time_point<steady_clock> waitStart = steady_clock::now();
+
+			while (!(received = sharedMemoryReader->TryRead(packet)) && steady_clock::now() - waitStart < milliseconds(RECEIVE_TIMEOUT_MILLISECONDS)) {
+				this_thread::yield();
+			}
+		}
+
+		if (!received) {
+			cerr << "No reading for " << RECEIVE_TIMEOUT_MILLISECONDS << " ms, stopping" << endl;
+			break;
+		}
+
+		const double now = (double)SteadyMicroseconds(steady_clock::now());
+		const long long frameId = (long long)packet[READING_FRAME_ID];
+
+		publishLatency.Add((now - packet[READING_PUBLISH_TIME]) / 1000);
+		captureLatency.Add((now - packet[READING_CAPTURE_TIME]) / 1000);
+		processingLatency.Add(packet[READING_LATENCY]);
+
+		if (lastFrameId >= 0 && frameId > lastFrameId + 1) {
+			skippedCount += frameId - lastFrameId - 1;
+		}
+
+		lastFrameId = frameId;
+		conesFoundCount += packet[READING_FOUND] != 0;
+		receivedCount++;
+	}
+
+	if (receivedCount == 0) {
+		return 1;
+	}
+
+	cout << "received " << receivedCount << " readings, " << conesFoundCount << " with a cone, " << skippedCount
+		<< " frames skipped or coalesced" << (sharedMemoryReader ? ", " + to_string(sharedMemoryReader->GetLostCount()) + " lost" : "") << endl;
+	cout << "  latency ms             mean       p50       p95       p99       max" << endl;
+
+	PrintLatencyRow("capture to process", processingLatency);
+	PrintLatencyRow("publish to receive", publishLatency);
+	PrintLatencyRow("capture to receive", captureLatency);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,531 @@
+// Records the cone details the pipeline finds in every frame of the calibration videos, and checks later builds against them.
+//
+// usage: Regression record [--corpus FILE] [--videos DIRECTORY] [PIPELINE OPTIONS]
+//        Regression check [--corpus FILE] [--videos DIRECTORY] [--position-tolerance INCHES] [--camera-tolerance PIXELS]
+//                         [--angle-tolerance DEGREES] [--max-reported N] [PIPELINE OPTIONS]
+//        Regression regions [--videos DIRECTORY] [--max-reported N] [PIPELINE OPTIONS]
+//
+// The frames run through the same ConeDetector as the robot and the calibration tool, timed by the frame rate of the video, so the
+// pipeline options select the search and filter paths to record or check: [--contours METHOD] [--pyramid LEVELS] [--roi] [--multi]
+// [--filter]. The nearest cone is recorded in multi cone mode and the filtered one with --filter. The corpus is recorded with the
+// default parameters, the other contour methods trace slightly different contours, so they only agree with it within tolerances.
+//
+// regions checks that processing a region does not depend on what the pipeline buffers held before. Every frame is searched as a
+// whole, which leaves the whole frame in the buffers, and then in the region the tracker would search next, or in the middle of the frame
+// if no cone was found. The region is searched again in a context whose buffers were cleared, and the two results have to be identical,
+// with each contour method. The coarse-to-fine search, which reuses the same buffers at the coarse size, is compared the same way. It
+// needs no corpus.
+//
+// Regression/Corpus.csv is the golden corpus. It was not recorded by this tool but by the pipeline the calibration tool had before the
+// detection moved to DetectionCore (the baseline commit 89d100c), with its default parameters: its PreProcessImage, FindConeContour and
+// ComputeConeDetails replayed over every decoded frame of each video, numbered from 0 and written in the format of record. Its
+// milliseconds are those of that pipeline on the recording machine, so the corpus fps of check is only comparable on the same machine.
+//
+// Run it from the solution directory, or pass --videos and --corpus. Outside of Visual Studio it builds with
+// g++ -O2 -std=c++14 Regression/Main.cpp -o regression $(pkg-config --cflags --libs opencv4)
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../ConeOrientation/CalibrationVideos.h"
+#include "../DetectionCore/CoarseToFine.h"
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/ConeDetector.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelineContext.h"
+#include "../DetectionCore/PipelinePolicies.h"
+#include "../DetectionCore/RegionOfInterest.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+const string CORPUS_HEADER =
+	"video,frame,found,centroid_x,centroid_y,tip_x,tip_y,centroid_camera_x,centroid_camera_y,tip_camera_x,tip_camera_y,angle,milliseconds";
+
+struct FrameRecord {
+
+	string Video;
+	int Frame = 0;
+	bool Found = false;
+	ConeDetails Details{};
+	double Milliseconds = 0;
+};
+
+struct Tolerances {
+
+	double Position = 1e-6; // inches
+	int CameraPosition = 0; // pixels
+	double Angle = 1e-6; // radians
+};
+
+string ToCsvLine(const FrameRecord& record) {
+
+	const ConeDetails& details = record.Details;
+
+	stringstream line;
+	line << setprecision(17) << record.Video << "," << record.Frame << "," << record.Found << ","
+		<< details.GetCentroidPosition().x << "," << details.GetCentroidPosition().y << ","
+		<< details.GetTipPosition().x << "," << details.GetTipPosition().y << ","
+		<< details.GetCentroidCameraPosition().x << "," << details.GetCentroidCameraPosition().y << ","
+		<< details.GetTipCameraPosition().x << "," << details.GetTipCameraPosition().y << ","
+		<< details.GetAngle() << "," << setprecision(6) << record.Milliseconds;
+
+	return line.str();
+}
+
+bool ParseCsvLine(const string& line, FrameRecord& record) {
+
+	vector<string> fields;
+	stringstream stream(line);
+	string field;
+
+	while (getline(stream, field, ',')) {
+		fields.push_back(field);
+	}
+
+	if (fields.size() != 13) {
+		return false;
+	}
+
+	try {
+		record.Video = fields[0];
+		record.Frame = stoi(fields[1]);
+		record.Found = fields[2] == "1";
+		record.Details = ConeDetails(
+			Point2d(stod(fields[3]), stod(fields[4])),
+			Point2d(stod(fields[5]), stod(fields[6])),
+			Point2i(stoi(fields[7]), stoi(fields[8])),
+			Point2i(stoi(fields[9]), stoi(fields[10])),
+			stod(fields[11]));
+		record.Milliseconds = stod(fields[12]);
+
+	} catch (const exception&) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * \brief Runs every frame of a video through a detector of its own, so the region tracking and the filter start over with each video.
+ *  The frames are timed by the frame rate of the video instead of when they are decoded, so the filter runs the same on every machine.
+ * \return False if the video could not be opened.
+ */
+bool ProcessVideo(const string& directory, const string& video, const Parameters& parameters, vector<FrameRecord>& records) {
+
+	VideoCapture videoCapture(CalibrationVideoPath(directory, video));
+
+	if (!videoCapture.isOpened()) {
+		return false;
+	}
+
+	const double frameRate = videoCapture.get(CAP_PROP_FPS) > 0 ? videoCapture.get(CAP_PROP_FPS) : 30;
+	BasicConeDetector<Timing> detector(parameters);
+
+	Mat frame;
+	int frameIndex = 0;
+
+	while (videoCapture.read(frame) && !frame.empty()) {
+
+		FrameRecord record;
+		record.Video = video;
+		record.Frame = frameIndex++;
+
+		const time_point<steady_clock> frameTime = time_point<steady_clock>(duration_cast<steady_clock::duration>(
+			duration<double>(record.Frame / frameRate)));
+
+		const DetectionResult& result = detector.Process(frame, frameTime);
+		record.Found = result.ConeFound;
+		record.Details = result.Details;
+		record.Milliseconds = detector.GetDebug().GetFrameMilliseconds();
+
+		records.push_back(record);
+	}
+
+	return true;
+}
+
+/**
+ * \brief Describes every field of the actual record that is outside the tolerances of the expected one.
+ */
+vector<string> FindDivergences(const FrameRecord& expected, const FrameRecord& actual, const Tolerances& tolerances) {
+
+	vector<string> divergences;
+
+	const auto compare = [&](const string& name, const double expectedValue, const double actualValue, const double tolerance) {
+
+		if (abs(expectedValue - actualValue) > tolerance) {
+			stringstream text;
+			text << setprecision(10) << name << " expected " << expectedValue << " got " << actualValue;
+			divergences.push_back(text.str());
+		}
+	};
+
+	const ConeDetails& e = expected.Details;
+	const ConeDetails& a = actual.Details;
+
+	compare("found", expected.Found, actual.Found, 0);
+	compare("centroid x", e.GetCentroidPosition().x, a.GetCentroidPosition().x, tolerances.Position);
+	compare("centroid y", e.GetCentroidPosition().y, a.GetCentroidPosition().y, tolerances.Position);
+	compare("tip x", e.GetTipPosition().x, a.GetTipPosition().x, tolerances.Position);
+	compare("tip y", e.GetTipPosition().y, a.GetTipPosition().y, tolerances.Position);
+	compare("centroid camera x", e.GetCentroidCameraPosition().x, a.GetCentroidCameraPosition().x, tolerances.CameraPosition);
+	compare("centroid camera y", e.GetCentroidCameraPosition().y, a.GetCentroidCameraPosition().y, tolerances.CameraPosition);
+	compare("tip camera x", e.GetTipCameraPosition().x, a.GetTipCameraPosition().x, tolerances.CameraPosition);
+	compare("tip camera y", e.GetTipCameraPosition().y, a.GetTipCameraPosition().y, tolerances.CameraPosition);
+	compare("angle", e.GetAngle(), a.GetAngle(), tolerances.Angle);
+
+	return divergences;
+}
+
+double TotalMilliseconds(const vector<FrameRecord>& records) {
+
+	double total = 0;
+
+	for (const FrameRecord& record : records) {
+		total += record.Milliseconds;
+	}
+
+	return total;
+}
+
+int Record(const string& corpusPath, const string& videoDirectory, const Parameters& parameters) {
+
+	ofstream corpus(corpusPath);
+
+	if (!corpus) {
+		cerr << "Could not write " << corpusPath << endl;
+		return 1;
+	}
+
+	corpus << CORPUS_HEADER << "\n";
+
+	for (const string& video : CALIBRATION_VIDEOS) {
+
+		vector<FrameRecord> records;
+
+		if (!ProcessVideo(videoDirectory, video, parameters, records)) {
+			cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+			return 1;
+		}
+
+		for (const FrameRecord& record : records) {
+			corpus << ToCsvLine(record) << "\n";
+		}
+
+		cout << "Recorded " << records.size() << " frames of " << video << endl;
+	}
+
+	return 0;
+}
+
+int Check(const string& corpusPath, const string& videoDirectory, const Parameters& parameters, const Tolerances& tolerances,
+	const int maxReported) {
+
+	ifstream corpus(corpusPath);
+
+	if (!corpus) {
+		cerr << "Could not read " << corpusPath << endl;
+		return 1;
+	}
+
+	map<string, vector<FrameRecord>> expectedRecords;
+	string line;
+	getline(corpus, line);
+
+	if (line != CORPUS_HEADER) {
+		cerr << corpusPath << " is not a regression corpus" << endl;
+		return 1;
+	}
+
+	while (getline(corpus, line)) {
+
+		FrameRecord record;
+
+		if (!ParseCsvLine(line, record)) {
+			cerr << "Could not parse the corpus line " << line << endl;
+			return 1;
+		}
+
+		expectedRecords[record.Video].push_back(record);
+	}
+
+	int reportedCount = 0;
+	int totalDivergentFrames = 0;
+
+	stringstream summary;
+	summary << fixed << setprecision(1)
+		<< "video     frames  divergent  corpus fps  current fps" << endl;
+
+	for (const string& video : CALIBRATION_VIDEOS) {
+
+		vector<FrameRecord> actualRecords;
+
+		if (!ProcessVideo(videoDirectory, video, parameters, actualRecords)) {
+			cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+			return 1;
+		}
+
+		const vector<FrameRecord>& expected = expectedRecords[video];
+		int divergentFrames = 0;
+
+		if (expected.size() != actualRecords.size()) {
+			cout << video << ": the corpus has " << expected.size() << " frames but the video decoded to " << actualRecords.size() << endl;
+			divergentFrames += (int)max(expected.size(), actualRecords.size()) - (int)min(expected.size(), actualRecords.size());
+		}
+
+		for (size_t i = 0; i < min(expected.size(), actualRecords.size()); i++) {
+
+			const vector<string> divergences = FindDivergences(expected[i], actualRecords[i], tolerances);
+
+			if (divergences.empty()) {
+				continue;
+			}
+
+			divergentFrames++;
+
+			if (reportedCount++ < maxReported) {
+				cout << video << " frame " << actualRecords[i].Frame << ":";
+
+				for (const string& divergence : divergences) {
+					cout << " " << divergence << ";";
+				}
+
+				cout << endl;
+			}
+		}
+
+		const double expectedMilliseconds = TotalMilliseconds(expected);
+		const double actualMilliseconds = TotalMilliseconds(actualRecords);
+
+		summary << left << setw(10) << video << right << setw(6) << actualRecords.size() << setw(11) << divergentFrames
+			<< setw(12) << (expectedMilliseconds > 0 ? expected.size() * 1000.0 / expectedMilliseconds : 0)
+			<< setw(13) << (actualMilliseconds > 0 ? actualRecords.size() * 1000.0 / actualMilliseconds : 0) << endl;
+
+		totalDivergentFrames += divergentFrames;
+	}
+
+	if (reportedCount > maxReported) {
+		cout << "... " << reportedCount - maxReported << " more divergent frames not shown" << endl;
+	}
+
+	cout << endl << summary.str() << endl;
+	cout << (totalDivergentFrames == 0 ? "No divergences from the corpus." : to_string(totalDivergentFrames) + " divergent frames.") << endl;
+
+	return totalDivergentFrames == 0 ? 0 : 1;
+}
+
+/**
+ * \brief Fills every image buffer of a context, so nothing of an earlier frame is left in them.
+ */
+void ClearBuffers(PipelineContext& context) {
+
+	for (Mat* buffer : { &context.ImageHsv, &context.MiddleMask, &context.HighlightMask, &context.LowLightMask, &context.MasksMerged,
+		&context.MaskBlurred, &context.MasksMergedDigitized, &context.Edges, &context.ContoursDilated, &context.PreProcessedImage,
+		&context.CoarseImage, &context.ComponentLabels, &context.ComponentMask }) {
+
+		buffer->setTo(Scalar(0));
+	}
+}
+
+/**
+ * \brief Searches a region of every frame right after searching the whole frame, and again in a context whose buffers were cleared, and
+ *  reports the frames where the two differ. The coarse-to-fine search is compared the same way.
+ * \return The number of frames that differ, or -1 if a video could not be opened.
+ */
+int CheckRegionsOfVideo(const string& directory, const string& video, const Parameters& parameters, const PipelineTables& tables,
+	const int maxReported, int& reportedCount) {
+
+	VideoCapture videoCapture(CalibrationVideoPath(directory, video));
+
+	if (!videoCapture.isOpened()) {
+		return -1;
+	}
+
+	PipelineContext reusedContext(parameters.CameraResolution, tables);
+	PipelineContext clearedContext(parameters.CameraResolution, tables);
+	RegionTracker tracker;
+	NoDebug debug;
+
+	Mat frame;
+	int frameIndex = 0;
+	int divergentFrames = 0;
+
+	while (videoCapture.read(frame) && !frame.empty()) {
+
+		const Rect wholeImage = Rect(0, 0, frame.cols, frame.rows);
+
+		FrameRecord whole;
+		whole.Found = DetectConeInWholeImage(frame, parameters, reusedContext, &whole.Details);
+		tracker.Update(wholeImage, frame.size(), whole.Found, reusedContext.ConeStats.Bounds, whole.Details);
+
+		Rect region = tracker.NextRegion(parameters, frame.size());
+
+		if (region == wholeImage) {
+			region = Rect(frame.cols / 4, frame.rows / 4, frame.cols / 2, frame.rows / 2);
+		}
+
+		FrameRecord reused;
+		reused.Found = DetectConeInRegion(frame, parameters, reusedContext, region, debug, &reused.Details);
+
+		ClearBuffers(clearedContext);
+
+		FrameRecord cleared;
+		cleared.Found = DetectConeInRegion(frame, parameters, clearedContext, region, debug, &cleared.Details);
+
+		vector<string> divergences = FindDivergences(cleared, reused, Tolerances());
+
+		// the coarse pass runs right after the region, in buffers still holding the full frame past its edges
+		FrameRecord reusedCoarse;
+		reusedCoarse.Found = DetectConeCoarseToFine(frame, parameters, reusedContext, &reusedCoarse.Details);
+
+		ClearBuffers(clearedContext);
+
+		FrameRecord clearedCoarse;
+		clearedCoarse.Found = DetectConeCoarseToFine(frame, parameters, clearedContext, &clearedCoarse.Details);
+
+		for (const string& divergence : FindDivergences(clearedCoarse, reusedCoarse, Tolerances())) {
+			divergences.push_back("coarse to fine " + divergence);
+		}
+
+		if (!divergences.empty()) {
+
+			divergentFrames++;
+
+			if (reportedCount++ < maxReported) {
+				cout << video << " frame " << frameIndex << " in " << region.width << "x" << region.height << " at " << region.x << "," << region.y << ":";
+
+				for (const string& divergence : divergences) {
+					cout << " " << divergence << ";";
+				}
+
+				cout << endl;
+			}
+		}
+
+		frameIndex++;
+	}
+
+	return divergentFrames;
+}
+
+int CheckRegions(const string& videoDirectory, const Parameters& parameters, const int maxReported) {
+
+	const int contourMethods[] = { CONTOUR_METHOD_EDGES, CONTOUR_METHOD_BOUNDARY, CONTOUR_METHOD_COMPONENTS };
+
+	int reportedCount = 0;
+	int totalDivergentFrames = 0;
+
+	for (const int contourMethod : contourMethods) {
+
+		Parameters methodParameters = parameters;
+		methodParameters.ContourMethod = contourMethod;
+		methodParameters.RoiTracking = 1;
+
+		const PipelineTables tables(methodParameters);
+
+		for (const string& video : CALIBRATION_VIDEOS) {
+
+			const int divergentFrames = CheckRegionsOfVideo(videoDirectory, video, methodParameters, tables, maxReported, reportedCount);
+
+			if (divergentFrames < 0) {
+				cerr << "Could not open " << CalibrationVideoPath(videoDirectory, video) << endl;
+				return 1;
+			}
+
+			cout << "contour method " << contourMethod << ", " << video << ": " << divergentFrames << " divergent frames" << endl;
+			totalDivergentFrames += divergentFrames;
+		}
+	}
+
+	if (reportedCount > maxReported) {
+		cout << "... " << reportedCount - maxReported << " more divergent frames not shown" << endl;
+	}
+
+	cout << (totalDivergentFrames == 0 ? "The regions do not depend on the earlier frames." :
+		to_string(totalDivergentFrames) + " divergent frames.") << endl;
+
+	return totalDivergentFrames == 0 ? 0 : 1;
+}
+
+int main(const int argc, char** argv) {
+
+	if (argc < 2 || (string(argv[1]) != "record" && string(argv[1]) != "check" && string(argv[1]) != "regions")) {
+		cerr << "usage: Regression record|check|regions [options]" << endl;
+		return 1;
+	}
+
+	const string mode = argv[1];
+	string corpusPath = "Regression/Corpus.csv";
+	string videoDirectory = "ConeOrientation/Calibration Videos";
+	Tolerances tolerances;
+	int maxReported = 50;
+	Parameters parameters = Parameters();
+
+	for (int i = 2; i < argc; i++) {
+
+		const string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--roi") {
+			parameters.RoiTracking = 1;
+
+		} else if (argument == "--multi") {
+			parameters.MultiCone = 1;
+
+		} else if (argument == "--filter") {
+			parameters.TemporalFilter = 1;
+
+		} else if (argument == "--corpus" && hasValue) {
+			corpusPath = argv[++i];
+
+		} else if (argument == "--videos" && hasValue) {
+			videoDirectory = argv[++i];
+
+		} else if (argument == "--position-tolerance" && hasValue) {
+			tolerances.Position = stod(argv[++i]);
+
+		} else if (argument == "--camera-tolerance" && hasValue) {
+			tolerances.CameraPosition = stoi(argv[++i]);
+
+		} else if (argument == "--angle-tolerance" && hasValue) {
+			tolerances.Angle = stod(argv[++i]) / 180.0 * PI;
+
+		} else if (argument == "--max-reported" && hasValue) {
+			maxReported = stoi(argv[++i]);
+
+		} else if (argument == "--contours" && hasValue) {
+			parameters.ContourMethod = stoi(argv[++i]);
+
+		} else if (argument == "--pyramid" && hasValue) {
+			parameters.PyramidLevels = stoi(argv[++i]);
+
+		} else {
+			cerr << "Unknown argument " << argument << endl;
+			return 1;
+		}
+	}
+
+	if (mode == "record") {
+		return Record(corpusPath, videoDirectory, parameters);
+	}
+
+	if (mode == "regions") {
+		return CheckRegions(videoDirectory, parameters, maxReported);
+	}
+
+	return Check(corpusPath, videoDirectory, parameters, tolerances, maxReported);
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+
+
+/**
+ * \brief A fixed capacity blocking queue for handing work between threads. When it is full, pushing drops the oldest item instead of
+ *  waiting, so a slow consumer always works on the most recent items. The storage is allocated once in the constructor.
+ */
+template <typename T>
+class BoundedQueue {
+
+		mutex Mutex;
+		condition_variable NotEmpty;
+		vector<T> Items;
+		size_t Head = 0;
+		size_t Count = 0;
+		bool Closed = false;
+		atomic<long long> DroppedCount;
+
+	public:
+
+		BoundedQueue(const size_t capacity) : Items(capacity), DroppedCount(0) {}
+
+		BoundedQueue(const BoundedQueue&) = delete;
+		BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+		/**
+		 * \brief Adds an item to the back of the queue without blocking.
+		 * \param dropped Set to the oldest item if the queue was full and it had to be removed to make room.
+		 * \return True if an item was dropped.
+		 */
+		bool Push(T item, T& dropped) {
+
+			bool droppedOldest = false;
+
+			{
+				lock_guard<mutex> lock(Mutex);
+
+				if (Count == Items.size()) {
+					dropped = move(Items[Head]);
+					Head = (Head + 1) % Items.size();
+					Count--;
+					droppedOldest = true;
+				}
+
+				Items[(Head + Count) % Items.size()] = move(item);
+				Count++;
+			}
+
+			NotEmpty.notify_one();
+
+			if (droppedOldest) {
+				DroppedCount++;
+			}
+
+			return droppedOldest;
+		}
+
+		/**
+		 * \brief Removes the item at the front of the queue, waiting until there is one.
+		 * \return False if the queue was closed and is empty.
+		 */
+		bool Pop(T& item) {
+
+			unique_lock<mutex> lock(Mutex);
+			NotEmpty.wait(lock, [this] { return Count > 0 || Closed; });
+
+			if (Count == 0) {
+				return false;
+			}
+
+			item = move(Items[Head]);
+			Head = (Head + 1) % Items.size();
+			Count--;
+
+			return true;
+		}
+
+		/**
+		 * \brief Wakes up every waiting consumer. Items still in the queue can be popped, after that Pop returns false.
+		 */
+		void Close() {
+
+			{
+				lock_guard<mutex> lock(Mutex);
+				Closed = true;
+			}
+
+			NotEmpty.notify_all();
+		}
+
+		/**
+		 * \brief The number of items that were dropped because the queue was full.
+		 */
+		long long GetDroppedCount() const {
+			return DroppedCount;
+		}
+
+};
\ No newline at end of file
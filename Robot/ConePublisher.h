@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../DetectionCore/ConeDetails.h"
+
+#include "ResultSink.h"
+#include "TripleBuffer.h"
+
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief Publishes the cone readings to a result sink on its own thread, so the vision loop never waits for NetworkTables or whichever
+ *  other sink the readings go to. When readings are submitted faster than they are published, only the newest one is published and the
+ *  others are counted as coalesced.
+ */
+class ConePublisher {
+
+		unique_ptr<ResultSink> Sink;
+		TripleBuffer<ConeReading> Readings;
+		thread PublisherThread;
+		atomic<bool> Running;
+		atomic<long long> PublishedCount;
+		atomic<long long> CoalescedCount;
+
+		void PublishLoop() {
+
+			while (Running.load(memory_order_relaxed)) {
+
+				if (!Readings.Acquire()) {
+					this_thread::sleep_for(milliseconds(1));
+					continue;
+				}
+
+				Sink->Publish(Readings.GetReadBuffer());
+				PublishedCount++;
+			}
+		}
+
+	public:
+
+		/**
+		 * \param sink Where the readings are published to, only ever used from the publisher thread.
+		 */
+		ConePublisher(unique_ptr<ResultSink> sink) : Sink(move(sink)), Running(false), PublishedCount(0), CoalescedCount(0) {}
+
+		ConePublisher(const ConePublisher&) = delete;
+		ConePublisher& operator=(const ConePublisher&) = delete;
+
+		~ConePublisher() {
+			Stop();
+		}
+
+		void Start() {
+
+			if (Running.exchange(true)) {
+				return;
+			}
+
+			PublisherThread = thread(&ConePublisher::PublishLoop, this);
+		}
+
+		void Stop() {
+
+			Running = false;
+
+			if (PublisherThread.joinable()) {
+				PublisherThread.join();
+			}
+		}
+
+		/**
+		 * \brief Hands the reading of a frame to the publisher thread without blocking. Only call this from a single thread.
+		 * \param cones Every cone found in multi cone mode, nullptr otherwise.
+		 */
+		void Submit(const long long frameId, const time_point<steady_clock> captureTime, const bool coneFound, const ConeDetails& details,
+			const vector<ConeDetails>* cones) {
+
+			ConeReading& reading = Readings.GetWriteBuffer();
+
+			reading.FrameId = frameId;
+			reading.CaptureTime = captureTime;
+			reading.Latency = duration<double, milli>(steady_clock::now() - captureTime).count();
+			reading.ConeFound = coneFound;
+			reading.Details = details;
+			reading.MultiCone = cones != nullptr;
+
+			// assigning into the buffer's vector reuses its capacity
+			if (cones != nullptr) {
+				reading.Cones.assign(cones->begin(), cones->end());
+			}
+
+			if (Readings.Publish()) {
+				CoalescedCount++;
+			}
+		}
+
+		/**
+		 * \brief The number of readings sent to the sink.
+		 */
+		long long GetPublishedCount() const {
+			return PublishedCount;
+		}
+
+		/**
+		 * \brief The number of readings that were replaced by a newer one before the publisher thread sent them.
+		 */
+		long long GetCoalescedCount() const {
+			return CoalescedCount;
+		}
+
+};
\ No newline at end of file
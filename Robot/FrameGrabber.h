@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "TripleBuffer.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief A camera frame together with the time it finished being read.
+ */
+struct CapturedFrame {
+
+	Mat Image;
+	time_point<steady_clock> CaptureTime;
+	long long Sequence = 0;
+};
+
+/**
+ * \brief Reads frames from a video capture on its own thread so the camera readout overlaps with processing. The processing loop always
+ *  gets the newest frame, frames it was too slow to pick up are dropped and counted.
+ */
+class FrameGrabber {
+
+		VideoCapture& Capture;
+		TripleBuffer<CapturedFrame> Frames;
+		thread CaptureThread;
+		atomic<bool> Running;
+		atomic<long long> CapturedFrameCount;
+		atomic<long long> DroppedFrameCount;
+		atomic<long long> FailedReadCount;
+
+		void CaptureLoop() {
+
+			long long sequence = 0;
+
+			while (Running.load(memory_order_relaxed)) {
+
+				CapturedFrame& frame = Frames.GetWriteBuffer();
+
+				// reading into the same Mat every time reuses its buffer
+				if (!Capture.read(frame.Image) || frame.Image.empty()) {
+					FailedReadCount++;
+					this_thread::sleep_for(milliseconds(1));
+					continue;
+				}
+
+				frame.CaptureTime = steady_clock::now();
+				frame.Sequence = ++sequence;
+
+				CapturedFrameCount++;
+
+				if (Frames.Publish()) {
+					DroppedFrameCount++;
+				}
+			}
+		}
+
+	public:
+
+		/**
+		 * \param capture An opened video capture. It must outlive the grabber and must not be used by anything else while it runs.
+		 */
+		FrameGrabber(VideoCapture& capture) : Capture(capture), Running(false), CapturedFrameCount(0), DroppedFrameCount(0), FailedReadCount(0) {}
+
+		FrameGrabber(const FrameGrabber&) = delete;
+		FrameGrabber& operator=(const FrameGrabber&) = delete;
+
+		~FrameGrabber() {
+			Stop();
+		}
+
+		void Start() {
+
+			if (Running.exchange(true)) {
+				return;
+			}
+
+			CaptureThread = thread(&FrameGrabber::CaptureLoop, this);
+		}
+
+		void Stop() {
+
+			Running = false;
+
+			if (CaptureThread.joinable()) {
+				CaptureThread.join();
+			}
+		}
+
+		/**
+		 * \brief Gets the newest captured frame without blocking. Only call this from a single processing thread.
+		 * \param frame Set to the newest frame, which stays valid until the next call that returns true.
+		 * \return False if no frame was captured since the last call.
+		 */
+		bool TryGetLatestFrame(const CapturedFrame*& frame) {
+
+			if (!Frames.Acquire()) {
+				return false;
+			}
+
+			frame = &Frames.GetReadBuffer();
+			return true;
+		}
+
+		/**
+		 * \brief The number of frames read from the camera so far.
+		 */
+		long long GetCapturedFrameCount() const {
+			return CapturedFrameCount;
+		}
+
+		/**
+		 * \brief The number of frames that were replaced by a newer one before the processing loop picked them up.
+		 */
+		long long GetDroppedFrameCount() const {
+			return DroppedFrameCount;
+		}
+
+		/**
+		 * \brief The number of reads that failed or returned an empty image.
+		 */
+		long long GetFailedReadCount() const {
+			return FailedReadCount;
+		}
+
+};
\ No newline at end of file
@@ -0,0 +1,349 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ResultSink.h"
+
+using namespace std;
+
+
+
+// the local sinks use POSIX sockets and shared memory, on Windows they are never valid
+
+/**
+ * \brief Sends every reading as one datagram of PACKET_SIZE doubles, for a receiver on the same machine or network instead of the robot.
+ *  Sending never blocks, a datagram that does not fit in the socket buffer is dropped.
+ */
+class UdpSink : public ResultSink {
+
+		int Socket = -1;
+		double Packet[PACKET_SIZE];
+
+#ifndef _WIN32
+		sockaddr_in Address;
+#endif
+
+	public:
+
+		UdpSink(const string& host, const int port) {
+
+#ifndef _WIN32
+			memset(&Address, 0, sizeof(Address));
+			Address.sin_family = AF_INET;
+			Address.sin_port = htons((uint16_t)port);
+
+			if (inet_pton(AF_INET, host.c_str(), &Address.sin_addr) == 1) {
+				Socket = socket(AF_INET, SOCK_DGRAM, 0);
+			}
+#endif
+		}
+
+		UdpSink(const UdpSink&) = delete;
+		UdpSink& operator=(const UdpSink&) = delete;
+
+		~UdpSink() override {
+
+#ifndef _WIN32
+			if (Socket >= 0) {
+				close(Socket);
+			}
+#endif
+		}
+
+		bool IsValid() const override {
+			return Socket >= 0;
+		}
+
+		void Publish(const ConeReading& reading) override {
+
+#ifndef _WIN32
+			if (Socket < 0) {
+				return;
+			}
+
+			EncodePacket(reading, Packet);
+			sendto(Socket, Packet, sizeof(Packet), MSG_DONTWAIT, (const sockaddr*)&Address, sizeof(Address));
+#endif
+		}
+
+};
+
+/**
+ * \brief Receives the datagrams of a UdpSink.
+ */
+class UdpReceiver {
+
+		int Socket = -1;
+
+	public:
+
+		/**
+		 * \param timeoutMilliseconds How long Receive waits for a datagram.
+		 */
+		UdpReceiver(const int port, const int timeoutMilliseconds) {
+
+#ifndef _WIN32
+			sockaddr_in address;
+			memset(&address, 0, sizeof(address));
+			address.sin_family = AF_INET;
+			address.sin_port = htons((uint16_t)port);
+			address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+			Socket = socket(AF_INET, SOCK_DGRAM, 0);
+
+			const timeval timeout = { timeoutMilliseconds / 1000, timeoutMilliseconds % 1000 * 1000 };
+
+			if (Socket >= 0 && (setsockopt(Socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+				::bind(Socket, (const sockaddr*)&address, sizeof(address)) != 0)) {
+
+				close(Socket);
+				Socket = -1;
+			}
+#endif
+		}
+
+		UdpReceiver(const UdpReceiver&) = delete;
+		UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+		~UdpReceiver() {
+
+#ifndef _WIN32
+			if (Socket >= 0) {
+				close(Socket);
+			}
+#endif
+		}
+
+		bool IsValid() const {
+			return Socket >= 0;
+		}
+
+		/**
+		 * \param packet Receives PACKET_SIZE values.
+		 * \return False if no complete packet arrived before the timeout.
+		 */
+		bool Receive(double* packet) {
+
+#ifndef _WIN32
+			return Socket >= 0 && recv(Socket, packet, PACKET_SIZE * sizeof(double), 0) == (ssize_t)(PACKET_SIZE * sizeof(double));
+#else
+			return false;
+#endif
+		}
+
+};
+
+const int SHARED_RING_CAPACITY = 64;
+
+/**
+ * \brief The layout of the shared memory of a SharedMemorySink. Each slot is guarded by a sequence number, which is odd while the slot is
+ *  being written and 2 * (n + 1) once it holds packet n, so a reader can tell when a slot was overwritten while it was copying it.
+ */
+struct SharedReadingRing {
+
+	struct Slot {
+
+		atomic<uint64_t> Sequence;
+		double Packet[PACKET_SIZE];
+	};
+
+	atomic<uint64_t> WrittenCount; // the number of packets written so far
+	Slot Slots[SHARED_RING_CAPACITY];
+};
+
+/**
+ * \brief Maps a named shared memory ring.
+ * \param create Creates the ring, or clears it if it already exists, instead of opening an existing one.
+ * \return The mapped ring, nullptr if it could not be created or opened.
+ */
+inline SharedReadingRing* MapSharedReadingRing(const string& name, const bool create) {
+
+#ifndef _WIN32
+	const int file = shm_open(name.c_str(), create ? O_CREAT | O_RDWR : O_RDWR, 0644);
+
+	if (file < 0) {
+		return nullptr;
+	}
+
+	if (create && ftruncate(file, sizeof(SharedReadingRing)) != 0) {
+		close(file);
+		return nullptr;
+	}
+
+	void* data = mmap(nullptr, sizeof(SharedReadingRing), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	close(file);
+
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+
+	SharedReadingRing* ring = (SharedReadingRing*)data;
+
+	if (create) {
+		memset(data, 0, sizeof(SharedReadingRing));
+	}
+
+	return ring;
+#else
+	return nullptr;
+#endif
+}
+
+inline void UnmapSharedReadingRing(SharedReadingRing* ring) {
+
+#ifndef _WIN32
+	if (ring != nullptr) {
+		munmap(ring, sizeof(SharedReadingRing));
+	}
+#endif
+}
+
+/**
+ * \brief Writes every reading into a ring of packets in named shared memory, for a reader on the same machine. The writer never waits for
+ *  the reader, a reader that falls more than SHARED_RING_CAPACITY packets behind loses the oldest ones.
+ */
+class SharedMemorySink : public ResultSink {
+
+		string Name;
+		SharedReadingRing* Ring;
+
+	public:
+
+		/**
+		 * \param name The name of the shared memory, starting with a slash.
+		 */
+		SharedMemorySink(const string& name) : Name(name), Ring(MapSharedReadingRing(name, true)) {}
+
+		SharedMemorySink(const SharedMemorySink&) = delete;
+		SharedMemorySink& operator=(const SharedMemorySink&) = delete;
+
+		~SharedMemorySink() override {
+
+			UnmapSharedReadingRing(Ring);
+
+#ifndef _WIN32
+			if (Ring != nullptr) {
+				shm_unlink(Name.c_str());
+			}
+#endif
+		}
+
+		bool IsValid() const override {
+			return Ring != nullptr;
+		}
+
+		void Publish(const ConeReading& reading) override {
+
+			if (Ring == nullptr) {
+				return;
+			}
+
+			const uint64_t index = Ring->WrittenCount.load(memory_order_relaxed);
+			SharedReadingRing::Slot& slot = Ring->Slots[index % SHARED_RING_CAPACITY];
+
+			slot.Sequence.store(2 * index + 1, memory_order_relaxed);
+			atomic_thread_fence(memory_order_release);
+
+			EncodePacket(reading, slot.Packet);
+
+			slot.Sequence.store(2 * index + 2, memory_order_release);
+			Ring->WrittenCount.store(index + 1, memory_order_release);
+		}
+
+};
+
+/**
+ * \brief Reads the packets of a SharedMemorySink in order.
+ */
+class SharedMemoryReader {
+
+		SharedReadingRing* Ring;
+		uint64_t NextIndex = 0;
+		long long LostCount = 0;
+
+	public:
+
+		/**
+		 * \param name The name the sink was created with. The sink has to be running already.
+		 */
+		SharedMemoryReader(const string& name) : Ring(MapSharedReadingRing(name, false)) {
+
+			if (Ring != nullptr) {
+				NextIndex = Ring->WrittenCount.load(memory_order_acquire);
+			}
+		}
+
+		SharedMemoryReader(const SharedMemoryReader&) = delete;
+		SharedMemoryReader& operator=(const SharedMemoryReader&) = delete;
+
+		~SharedMemoryReader() {
+			UnmapSharedReadingRing(Ring);
+		}
+
+		bool IsValid() const {
+			return Ring != nullptr;
+		}
+
+		/**
+		 * \brief Copies the next packet without blocking.
+		 * \param packet Receives PACKET_SIZE values.
+		 * \return False if there is no new packet yet.
+		 */
+		bool TryRead(double* packet) {
+
+			while (Ring != nullptr) {
+
+				const uint64_t writtenCount = Ring->WrittenCount.load(memory_order_acquire);
+
+				if (NextIndex >= writtenCount) {
+					return false;
+				}
+
+				// the writer lapped the reader, skip to the oldest packet that is still in the ring
+				if (writtenCount - NextIndex > SHARED_RING_CAPACITY) {
+					LostCount += writtenCount - SHARED_RING_CAPACITY - NextIndex;
+					NextIndex = writtenCount - SHARED_RING_CAPACITY;
+				}
+
+				const SharedReadingRing::Slot& slot = Ring->Slots[NextIndex % SHARED_RING_CAPACITY];
+				const uint64_t expectedSequence = 2 * NextIndex + 2;
+
+				if (slot.Sequence.load(memory_order_acquire) == expectedSequence) {
+
+					memcpy(packet, slot.Packet, sizeof(slot.Packet));
+					atomic_thread_fence(memory_order_acquire);
+
+					if (slot.Sequence.load(memory_order_relaxed) == expectedSequence) {
+						NextIndex++;
+						return true;
+					}
+				}
+
+				// overwritten while copying it, which only happens when the reader fell behind, so it counts as lost
+				LostCount++;
+				NextIndex++;
+			}
+
+			return false;
+		}
+
+		/**
+		 * \brief The number of packets that were overwritten before they were read.
+		 */
+		long long GetLostCount() const {
+			return LostCount;
+		}
+
+};
\ No newline at end of file
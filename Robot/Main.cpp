@@ -1,22 +1,31 @@
 #include <chrono>
+#include <memory>
 #include <string>
+#include <thread>
 
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 
 #include <fmt/format.h>
 #include <networktables/NetworkTableInstance.h>
-#include <networktables/NetworkTable.h>
-#include <networktables/DoubleTopic.h>
 
-#include "ConeDetails.h"
-#include "Contours.h"
-#include "Parameters.h"
-#include "Wrappers.h"
-#include "Trigonometry.h"
-#include "Points.h"
+#include "../DetectionCore/AllocationCounter.h"
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/ConeDetector.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelinePolicies.h"
+#include "../DetectionCore/Trigonometry.h"
 
-#define PRINT_DATA true;
+#include "ConePublisher.h"
+#include "FrameGrabber.h"
+#include "LocalSinks.h"
+#include "NetworkTablesSink.h"
+#include "RobotParameters.h"
+#include "StagedPipeline.h"
+
+//#define LOCAL_NT_SERVER true // runs a NetworkTables server on the pi to test the publisher against, instead of connecting to the robot
+//#define UDP_SINK 5800 // sends the readings to this UDP port on the pi instead of NetworkTables, for the receiver tool
+//#define SHARED_MEMORY_SINK "/cone_readings" // writes the readings to this shared memory instead of NetworkTables, for the receiver tool
 
 using namespace cv;
 using namespace std;
@@ -24,10 +33,8 @@ using namespace std::chrono;
 
 
 
-nt::DoublePublisher dblPubFound, dblPubAngle, dblPubX, dblPubY;
 nt::NetworkTableInstance inst;
 
-#ifdef PRINT_DATA
 string FixLength(const string& text, const char length) {
 
 	const int textLength = text.length();
@@ -44,240 +51,181 @@ string FixLength(const string& text, const char length) {
 
 	return text + spaces.substr(0, length - textLength);
 }
-#endif
 
-void CeilingToOdd(int& number) {
+string ConeDetailsText(const ConeDetails& coneDetails) {
 
-	if (number % 2 == 0) {
-		number++;
-	}
+	return
+		",   x: " + FixLength(to_string(coneDetails.GetCentroidPosition().x), 8) +
+		",   y: " + FixLength(to_string(coneDetails.GetCentroidPosition().y), 8) +
+		",   angle: " + FixLength(to_string(coneDetails.GetAngle() * 180l / PI), 8);
 }
 
-void PreProcessImage(const Mat& sourceImage, Mat& targetImage, Parameters parameters) {
-
-	Mat imageHsv, masksMerged, masksMergedDigitized, edges, contoursDilated;
-	Mat middleMask, highlightMask, lowLightMask;
-
-	CeilingToOdd(parameters.TotalMaskBlur);
-	CeilingToOdd(parameters.ContourDilation);
-
-	Scalar middleLowerColorLimit = Scalar(parameters.MiddleHueMin, parameters.MiddleSaturationMin, parameters.MiddleValueMin);
-	Scalar middleUpperColorLimit = Scalar(parameters.MiddleHueMax, parameters.MiddleSaturationMax, parameters.MiddleValueMax);
-
-	Scalar highlightLowerColorLimit = Scalar(parameters.HighlightHueMin, parameters.HighlightSaturationMin, parameters.HighlightValueMin);
-	Scalar highlightUpperColorLimit = Scalar(parameters.HighlightHueMax, parameters.HighlightSaturationMax, parameters.HighlightValueMax);
-
-	Scalar lowLightLowerColorLimit = Scalar(parameters.LowLightHueMin, parameters.LowLightSaturationMin, parameters.LowLightValueMin);
-	Scalar lowLightUpperColorLimit = Scalar(parameters.LowLightHueMax, parameters.LowLightSaturationMax, parameters.LowLightValueMax);
-
-	cvtColor(sourceImage, imageHsv, COLOR_BGR2HSV);
-	inRange(imageHsv, middleLowerColorLimit, middleUpperColorLimit, middleMask);
-	inRange(imageHsv, highlightLowerColorLimit, highlightUpperColorLimit, highlightMask);
-	inRange(imageHsv, lowLightLowerColorLimit, lowLightUpperColorLimit, lowLightMask);
-
-	masksMerged = parameters.MiddleMaskWeight / 100.0 * middleMask + parameters.HighlightMaskWeight / 100.0 * highlightMask + parameters.LowLightMaskWeight / 100.0 * lowLightMask;
-
-	Mat maskBlurred;
-	GaussianBlur(masksMerged, maskBlurred, Size(parameters.TotalMaskBlur, parameters.TotalMaskBlur), 5, 0);
-
-	inRange(maskBlurred, parameters.MaskThreshold, Scalar(255), masksMergedDigitized);
+/**
+ * \brief Prints the timing of a frame of the serial pipeline, how many frames were dropped and coalesced on the way, and the cone.
+ * \param readingMilliseconds How long the loop waited for the frame.
+ */
+void PrintFrame(const Timing& timing, const double readingMilliseconds, const CapturedFrame& frame, const DetectionResult& result,
+	const RegionTracker& regionTracker, const FrameGrabber& frameGrabber, const ConePublisher& publisher, const Parameters& parameters,
+	const long long frameAllocations) {
 
-	Canny(masksMergedDigitized, edges, parameters.CannyThreshold1, parameters.CannyThreshold2);
+	duration<double, milli> latency = steady_clock::now() - frame.CaptureTime;
+	string stageTimes;
 
-	SquareDilate(edges, contoursDilated, parameters.ContourDilation);
-
-	copyMakeBorder(contoursDilated, targetImage, 1, 1, 1, 1, BORDER_CONSTANT, Scalar(255, 255, 255));
-}
-
-vector<Point2i> FindConeContour(const Mat& sourceImage, const Parameters parameters) {
-
-	vector<vector<Point2i>> contours;
-	vector<Vec4i> hierarchy;
-
-	findContours(sourceImage, contours, hierarchy, RETR_LIST, CHAIN_APPROX_NONE);
-
-	const vector<vector<Point2i>> filteredContours = FilteredContours(contours, parameters.MinContourArea, parameters.MaxContourArea);
-
-	if (filteredContours.empty()) {
-		return vector<Point2i>();
+	for (int stage = 0; stage < PIPELINE_STAGE_COUNT; stage++) {
+		if (timing.GetStageRunCount(stage) > 0) {
+			stageTimes += ",   " + string(PIPELINE_STAGE_NAMES[stage]) + ": " + FixLength(to_string(timing.GetStageMilliseconds(stage)), 8);
+		}
 	}
 
-	return *MostCentralContour(filteredContours, parameters.CameraResolution);
+	fmt::print(
+		"reading: " + FixLength(to_string(readingMilliseconds), 8) +
+		",   finding: " + FixLength(to_string(timing.GetFrameMilliseconds()), 8) +
+		stageTimes +
+		",   latency: " + FixLength(to_string(latency.count()), 8) +
+		",   dropped: " + FixLength(to_string(frameGrabber.GetDroppedFrameCount()), 6) +
+		",   coalesced: " + FixLength(to_string(publisher.GetCoalescedCount()), 6) +
+		(parameters.RoiTracking != 0 ? ",   roi hits: " + FixLength(to_string(regionTracker.GetHitRate() * 100), 6) + "%" : "") +
+		(parameters.MultiCone != 0 ? ",   cones: " + FixLength(to_string(result.Cones.size()), 3) : "") +
+		ConeDetailsText(result.Details) +
+		(ALLOCATIONS_COUNTED ? ",   allocations: " + to_string(frameAllocations) : "") +
+		"\n");
 }
 
-void GetConeCornerGroups(const vector<Point2i>& coneContour, const Point2i centroidCameraPosition,
-	const Point2i farthestPointCameraPosition, vector<vector<Point2i>>& cornerGroups) {
+/**
+ * \brief The production pipeline prints nothing.
+ */
+void PrintFrame(const NoDebug& debug, const double readingMilliseconds, const CapturedFrame& frame, const DetectionResult& result,
+	const RegionTracker& regionTracker, const FrameGrabber& frameGrabber, const ConePublisher& publisher, const Parameters& parameters,
+	const long long frameAllocations) {}
 
-	const double distanceToTip = DistanceBetweenPoints(centroidCameraPosition, farthestPointCameraPosition);
+/**
+ * \brief Runs the staged pipeline, which detects on its own threads with its own detector, so the debug policy only decides whether every frame
+ *  is printed.
+ */
+template <typename DebugPolicy>
+void RunStagedPipeline(VideoCapture& videoCapture, const Parameters& parameters, ConePublisher& publisher) {
 
-	cornerGroups = vector<vector<Point2i>>();
-	cornerGroups.emplace_back();
+	fmt::print("Running the staged pipeline with a depth of " + to_string(parameters.PipelineDepth) + ".\n");
 
-	for (int i = 0; i < coneContour.size(); i++) {
+	time_point<steady_clock> lastPublishTime = steady_clock::now();
 
-		Point2i point = coneContour[i];
+	StagedPipeline pipeline(videoCapture, parameters, parameters.PipelineDepth, [&](const PipelineFrame& frame) {
 
-		if (DistanceBetweenPoints(point, centroidCameraPosition) < distanceToTip * 0.85) {
-			continue;
-		}
+		publisher.Submit(frame.Sequence, frame.CaptureTime, frame.ConeFound, frame.Details, parameters.MultiCone != 0 ? &frame.Cones : nullptr);
 
-		if (cornerGroups.back().empty()) {
-			cornerGroups.back().push_back(point);
-			continue;
+		if (!DebugPolicy::IsTimed) {
+			return;
 		}
 
-		const bool continuationOfPreviousCorner = coneContour[i - 1] == cornerGroups.back().back();
-		const bool notTooFarFromPreviousPoint = DistanceBetweenPoints(coneContour[i], cornerGroups.back().back()) < 15;
-		const bool closeToPreviousPoint = DistanceBetweenPoints(coneContour[i], cornerGroups.back().back()) < 6;
-
-		if ((continuationOfPreviousCorner && notTooFarFromPreviousPoint) || closeToPreviousPoint) {
-			cornerGroups.back().push_back(point);
-			continue;
-		}
+		time_point<steady_clock> publishTime = steady_clock::now();
+		duration<double, milli> frameInterval = publishTime - lastPublishTime;
+		duration<double, milli> latency = publishTime - frame.CaptureTime;
+		lastPublishTime = publishTime;
 
-		cornerGroups.emplace_back();
-		cornerGroups.back().push_back(point);
-	}
-
-	if (cornerGroups.size() < 2) {
-		return;
-	}
-
-	if (cornerGroups.back().back() == coneContour.back() && cornerGroups.front().front() == coneContour.front()) {
+		fmt::print(
+			"interval: " + FixLength(to_string(frameInterval.count()), 8) +
+			",   latency: " + FixLength(to_string(latency.count()), 8) +
+			",   dropped: " + FixLength(to_string(frame.DroppedFrameCount), 6) +
+			",   coalesced: " + FixLength(to_string(publisher.GetCoalescedCount()), 6) +
+			ConeDetailsText(frame.Details) + "\n");
+	});
 
-		for (Point2i point : cornerGroups.back()) {
-			cornerGroups.front().push_back(point);
-		}
+	pipeline.Start();
 
-		cornerGroups.pop_back();
+	while (true) {
+		this_thread::sleep_for(seconds(1));
 	}
 }
 
-vector<Point2i> GetHighestInEachCornerGroup(const vector<vector<Point2i>>& cornerGroups,
-	Point2i& highestPointInHighestCorner, Point2i& highestPointInSecondHighestCorner) {
-
-	vector<Point2i> northMostInEachCornerGroup{};
-
-	for (const vector<Point2i>& cornerGroup : cornerGroups) {
+/**
+ * \brief Runs every stage on the main thread with a detector specialized on the debug policy, Timing to print every frame with the time
+ *  of each stage, NoDebug to compile all of that away.
+ */
+template <typename DebugPolicy>
+void RunSerialPipeline(VideoCapture& videoCapture, const Parameters& parameters, ConePublisher& publisher) {
 
-		northMostInEachCornerGroup.push_back(cornerGroup[0]);
+	BasicConeDetector<DebugPolicy> coneDetector(parameters);
+	InstallAllocationCounter();
 
-		for (Point2i point : cornerGroup) {
+	FrameGrabber frameGrabber(videoCapture);
+	frameGrabber.Start();
 
-			if (point.y < northMostInEachCornerGroup.back().y) {
-				northMostInEachCornerGroup.pop_back();
-				northMostInEachCornerGroup.push_back(point);
-			}
-		}
-	}
+	while (true) {
 
-	highestPointInHighestCorner = northMostInEachCornerGroup[0].y < northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
-	highestPointInSecondHighestCorner = northMostInEachCornerGroup[0].y > northMostInEachCornerGroup[1].y ? northMostInEachCornerGroup[0] : northMostInEachCornerGroup[1];
-	for (int i = 2; i < northMostInEachCornerGroup.size(); i++) {
+		const time_point<steady_clock> startTime = DebugPolicy::IsTimed ? steady_clock::now() : time_point<steady_clock>();
 
-		if (northMostInEachCornerGroup[i].y < highestPointInSecondHighestCorner.y) {
-			highestPointInSecondHighestCorner = northMostInEachCornerGroup[i];
-		}
+		const CapturedFrame* frame = nullptr;
 
-		if (northMostInEachCornerGroup[i].y < highestPointInHighestCorner.y) {
-			const Point2i temp = highestPointInSecondHighestCorner;
-			highestPointInSecondHighestCorner = highestPointInHighestCorner;
-			highestPointInHighestCorner = temp;
+		while (!frameGrabber.TryGetLatestFrame(frame)) {
+			this_thread::sleep_for(milliseconds(1));
 		}
-	}
 
-	return northMostInEachCornerGroup;
-}
+		const Mat& image = frame->Image;
+		const double readingMilliseconds = DebugPolicy::IsTimed ? duration<double, milli>(steady_clock::now() - startTime).count() : 0;
 
-Point2i AdjustTipFromCornerPoints(const vector<vector<Point2i>>& cornerGroups, const Point2i currentTipPosition) {
+		const long long allocationsBefore = GetAllocationCount();
 
-	if (cornerGroups.size() < 4) {
-		return currentTipPosition;
-	}
+		const DetectionResult& result = coneDetector.Process(image, frame->CaptureTime);
 
-	if (cornerGroups.size() == 4) {
+		const long long frameAllocations = GetAllocationCount() - allocationsBefore;
 
-		Point2i highestPoint;
-		Point2i secondHighestPoint;
-		GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondHighestPoint);
+		publisher.Submit(frame->Sequence, frame->CaptureTime, result.ConeFound, result.Details,
+			parameters.MultiCone != 0 ? &result.Cones : nullptr);
 
-		if (highestPoint.y - secondHighestPoint.y < -5) {
-			return highestPoint;
-		}
+		PrintFrame(coneDetector.GetDebug(), readingMilliseconds, *frame, result, coneDetector.GetRegionTracker(), frameGrabber, publisher,
+			parameters, frameAllocations);
 
-		return Point2i((highestPoint.x + secondHighestPoint.x) / 2, (highestPoint.y + secondHighestPoint.y) / 2);
+		waitKey(1);
 	}
+}
 
-	if (cornerGroups.size() == 5) {
-
-		vector<Point2i> corners{};
+unique_ptr<ResultSink> OpenResultSink() {
 
-		corners.reserve(cornerGroups.size());
-		for (const vector<Point2i>& cornerGroup : cornerGroups) {
-			corners.push_back(AveragePointInGroup(cornerGroup));
-		}
+#if defined(UDP_SINK)
+	return unique_ptr<ResultSink>(new UdpSink("127.0.0.1", UDP_SINK));
+#elif defined(SHARED_MEMORY_SINK)
+	return unique_ptr<ResultSink>(new SharedMemorySink(SHARED_MEMORY_SINK));
+#else
+	inst = nt::NetworkTableInstance::GetDefault();
+	//auto pubOp = new PubSubOption();
+#ifdef LOCAL_NT_SERVER
+	inst.StartServer();
+#else
+	inst.StartClient4("example client");
+	inst.SetServerTeam(4678);  // where TEAM=190, 294, etc, or use inst.setServer("hostname") or similar
+	inst.StartDSClient();  // recommended if running on DS computer; this gets the robot IP from the DS
+#endif
 
-		Point2i highestPoint = corners[0];
+	return unique_ptr<ResultSink>(new NetworkTablesSink(inst, "rpi", true));
+#endif
+}
 
-		for (const Point2i point : corners) {
-			if (point.y < highestPoint.y) {
-				highestPoint = point;
-			}
-		}
+// usage: Robot [--quiet] [--depth N]
+// Every reading is printed with the time of each stage, like the robot always did, unless --quiet selects the detector that compiles the
+// timing away. --depth overrides the PipelineDepth of the robot parameters, so the serial pipeline (0) and the staged one can be
+// compared on the pi without rebuilding.
+int main(const int argc, char** argv) {
 
-		return highestPoint;
-	}
+	Parameters parameters = RobotParameters();
+	bool printFrames = true;
 
-	Point2i highestPoint;
-	Point2i secondNorthMost;
-	GetHighestInEachCornerGroup(cornerGroups, highestPoint, secondNorthMost);
+	for (int i = 1; i < argc; i++) {
 
-	if (highestPoint.y - secondNorthMost.y < -5) {
-		return highestPoint;
-	}
+		const string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
 
-	double sumX = 0;
-	int numberOfPoints = 0;
+		if (argument == "--quiet") {
+			printFrames = false;
 
-	for (const vector<Point2i>& cornerGroup : cornerGroups) {
+		} else if (argument == "--depth" && hasValue) {
+			parameters.PipelineDepth = max(0, stoi(argv[++i]));
 
-		for (const Point2i point : cornerGroup) {
-			numberOfPoints++;
-			sumX += point.x;
+		} else {
+			fmt::print("Unknown argument " + argument + "\n");
+			return 1;
 		}
 	}
 
-	return Point2i(sumX / numberOfPoints, highestPoint.y);
-}
-
-bool ComputeConeDetails(const vector<Point2i>& coneContour, const Parameters& parameters, ConeDetails* output, vector<vector<Point2i>>& cornerGroups) {
-
-	if (coneContour.empty()) {
-		return false;
-	}
-
-	const Point2i centroid = ContourCentroid(coneContour);
-	Point2i farthestPoint = FarthestPoint(coneContour, centroid);
-
-	GetConeCornerGroups(coneContour, centroid, farthestPoint, cornerGroups);
-	farthestPoint = AdjustTipFromCornerPoints(cornerGroups, farthestPoint);
-
-	const Point2d centroidPosition = CalculateObjectDisplacement(centroid, parameters.CameraResolution,
-		parameters.CameraFov, parameters.CameraOffset, parameters.CameraAngle);
-
-	const Point2d tipPosition = CalculateObjectDisplacement(farthestPoint, parameters.CameraResolution,
-		parameters.CameraFov, parameters.CameraOffset, parameters.CameraAngle);
-
-	const double coneAngle = CalculateConeAngle(centroidPosition, tipPosition);
-
-	const double adjustedConeAngle = ApplyConeTippedErrorCorrection(coneAngle, centroid, parameters.CameraAngle, parameters.CameraResolution, parameters.CameraFov);
-
-	*output = ConeDetails(centroidPosition, tipPosition, centroid, farthestPoint, adjustedConeAngle);
-	return true;
-}
-
-int main() {
-
 	fmt::print("Starting cone detection.\n");
 	fmt::print("Waiting for 15 seconds for the rio to boot.\n");
 
@@ -287,60 +235,27 @@ int main() {
 		return 0;
 	}
 
-	Mat image, preProcessedImage;
-
-	Parameters parameters = Parameters();
-	CeilingToOdd(parameters.TotalMaskBlur);
-	CeilingToOdd(parameters.ContourDilation);
-
-	inst = nt::NetworkTableInstance::GetDefault();
-	auto table = inst.GetTable("rpi");
-	//auto pubOp = new PubSubOption();
-	inst.StartClient4("example client");
-	inst.SetServerTeam(4678);  // where TEAM=190, 294, etc, or use inst.setServer("hostname") or similar
-	inst.StartDSClient();  // recommended if running on DS computer; this gets the robot IP from the DS
-	dblPubFound = table->GetDoubleTopic("cone_found").Publish();
-	dblPubAngle = table->GetDoubleTopic("cone_angle").Publish();
-	dblPubX = table->GetDoubleTopic("cone_x").Publish();
-	dblPubY = table->GetDoubleTopic("cone_y").Publish();
-
-	while (true) {
-
-#ifdef PRINT_DATA
-		time_point<system_clock> startTime = high_resolution_clock::now();
-#endif
-
-		videoCapture.read(image);
-
-#ifdef PRINT_DATA
-		time_point<system_clock> readingTime = high_resolution_clock::now();
-#endif
-
-		PreProcessImage(image, preProcessedImage, parameters);
+	unique_ptr<ResultSink> sink = OpenResultSink();
+	if (!sink->IsValid()) {
+		fmt::print("The result sink was not opened.\n");
+		return 0;
+	}
 
-		ConeDetails coneDetails{};
-		vector<vector<Point2i>> cornerGroups{};
-		vector<Point2i> coneContour = FindConeContour(preProcessedImage, parameters);
-		bool coneFound = ComputeConeDetails(coneContour, parameters, &coneDetails, cornerGroups);
+	ConePublisher publisher(move(sink));
+	publisher.Start();
 
-		dblPubFound.Set(coneFound);
-		dblPubAngle.Set(coneDetails.GetAngle() * 180l / PI);
-		dblPubX.Set(coneDetails.GetCentroidPosition().x);
-		dblPubY.Set(coneDetails.GetCentroidPosition().y);
+	if (parameters.PipelineDepth > 0 && printFrames) {
+		RunStagedPipeline<Timing>(videoCapture, parameters, publisher);
 
-#ifdef PRINT_DATA
-		time_point<system_clock> endTime = high_resolution_clock::now();
-		duration<double, milli> readingDuration = readingTime - startTime;
-		duration<double, milli> findingDuration = endTime - readingTime;
+	} else if (parameters.PipelineDepth > 0) {
+		RunStagedPipeline<NoDebug>(videoCapture, parameters, publisher);
 
-		fmt::print(
-			"reading: " + FixLength(to_string(readingDuration.count()), 8) +
-			",   finding: " + FixLength(to_string(findingDuration.count()), 8) +
-			",   x: " + FixLength(to_string(coneDetails.GetCentroidPosition().x), 8) +
-			",   y: " + FixLength(to_string(coneDetails.GetCentroidPosition().y), 8) +
-			",   angle: " + FixLength(to_string(coneDetails.GetAngle() * 180l / PI), 8) + "\n");
-#endif
+	} else if (printFrames) {
+		RunSerialPipeline<Timing>(videoCapture, parameters, publisher);
 
-		waitKey(1);
+	} else {
+		RunSerialPipeline<NoDebug>(videoCapture, parameters, publisher);
 	}
+
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <networktables/DoubleArrayTopic.h>
+#include <networktables/DoubleTopic.h>
+#include <networktables/NetworkTable.h>
+#include <networktables/NetworkTableInstance.h>
+
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/Trigonometry.h"
+
+#include "ResultSink.h"
+
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief Publishes every reading as the cone_reading array, timestamped with its capture time so every value in it is known to belong to
+ *  the same frame. The separate cone topics are still published, with the same timestamp, for the robot code that reads them.
+ */
+class NetworkTablesSink : public ResultSink {
+
+		nt::NetworkTableInstance Instance;
+		nt::DoubleArrayPublisher ReadingPublisher;
+		nt::DoublePublisher FoundPublisher, AnglePublisher, XPublisher, YPublisher, CountPublisher;
+		nt::DoubleArrayPublisher AnglesPublisher, XsPublisher, YsPublisher;
+		bool FlushEveryReading;
+
+		// reused for every reading so publishing does not allocate
+		vector<double> Values, Angles, Xs, Ys;
+
+	public:
+
+		/**
+		 * \param instance The NetworkTables instance to publish to, a client connected to the robot or a local server to test against.
+		 * \param flushEveryReading Sends every reading right away instead of at the next periodic update of the client.
+		 */
+		NetworkTablesSink(nt::NetworkTableInstance instance, const string& tableName, const bool flushEveryReading) :
+			Instance(instance), FlushEveryReading(flushEveryReading), Values(READING_SIZE) {
+
+			const shared_ptr<nt::NetworkTable> table = Instance.GetTable(tableName);
+
+			ReadingPublisher = table->GetDoubleArrayTopic("cone_reading").Publish();
+			FoundPublisher = table->GetDoubleTopic("cone_found").Publish();
+			AnglePublisher = table->GetDoubleTopic("cone_angle").Publish();
+			XPublisher = table->GetDoubleTopic("cone_x").Publish();
+			YPublisher = table->GetDoubleTopic("cone_y").Publish();
+			CountPublisher = table->GetDoubleTopic("cone_count").Publish();
+			AnglesPublisher = table->GetDoubleArrayTopic("cones_angle").Publish();
+			XsPublisher = table->GetDoubleArrayTopic("cones_x").Publish();
+			YsPublisher = table->GetDoubleArrayTopic("cones_y").Publish();
+
+			Angles.reserve(16);
+			Xs.reserve(16);
+			Ys.reserve(16);
+		}
+
+		bool IsValid() const override {
+			return true;
+		}
+
+		void Publish(const ConeReading& reading) override {
+
+			// the capture time in the time base of NetworkTables, which is synchronized with the robot
+			const int64_t now = nt::Now();
+			const int64_t captureTime = now - duration_cast<microseconds>(steady_clock::now() - reading.CaptureTime).count();
+			const ConeDetails& details = reading.Details;
+
+			EncodeReading(reading, captureTime, now, Values.data());
+			ReadingPublisher.Set(Values, captureTime);
+
+			FoundPublisher.Set(reading.ConeFound, captureTime);
+			AnglePublisher.Set(details.GetAngle() * 180l / PI, captureTime);
+			XPublisher.Set(details.GetCentroidPosition().x, captureTime);
+			YPublisher.Set(details.GetCentroidPosition().y, captureTime);
+
+			if (reading.MultiCone) {
+
+				Angles.clear();
+				Xs.clear();
+				Ys.clear();
+
+				for (const ConeDetails& cone : reading.Cones) {
+					Angles.push_back(cone.GetAngle() * 180l / PI);
+					Xs.push_back(cone.GetCentroidPosition().x);
+					Ys.push_back(cone.GetCentroidPosition().y);
+				}
+
+				CountPublisher.Set((double)reading.Cones.size(), captureTime);
+				AnglesPublisher.Set(Angles, captureTime);
+				XsPublisher.Set(Xs, captureTime);
+				YsPublisher.Set(Ys, captureTime);
+			}
+
+			// sends the values right away instead of at the next periodic update of the client
+			if (FlushEveryReading) {
+				Instance.Flush();
+			}
+		}
+
+};
\ No newline at end of file
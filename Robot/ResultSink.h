@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/Trigonometry.h"
+
+using namespace std;
+using namespace std::chrono;
+
+
+
+// the positions of the values in a reading, which is published as the cone_reading array and starts every packet of the local sinks
+const int READING_FRAME_ID = 0;
+const int READING_CAPTURE_TIME = 1; // microseconds, in the time base of the sink
+const int READING_LATENCY = 2; // milliseconds from the capture to the end of processing
+const int READING_FOUND = 3;
+const int READING_CENTROID_X = 4;
+const int READING_CENTROID_Y = 5;
+const int READING_TIP_X = 6;
+const int READING_TIP_Y = 7;
+const int READING_CENTROID_CAMERA_X = 8;
+const int READING_CENTROID_CAMERA_Y = 9;
+const int READING_TIP_CAMERA_X = 10;
+const int READING_TIP_CAMERA_Y = 11;
+const int READING_ANGLE = 12; // degrees
+const int READING_PUBLISH_TIME = 13; // microseconds, in the time base of the sink
+const int READING_SIZE = 14;
+
+// a packet of the local sinks is a reading followed by the number of cones and the x, y and angle of each, all doubles
+const int PACKET_CONE_COUNT = READING_SIZE;
+const int PACKET_CONES = READING_SIZE + 1;
+const int PACKET_CONE_LIMIT = 16;
+const int PACKET_SIZE = PACKET_CONES + 3 * PACKET_CONE_LIMIT;
+
+/**
+ * \brief The result of processing one frame, as it is handed to the publisher thread.
+ */
+struct ConeReading {
+
+	long long FrameId = 0;
+	time_point<steady_clock> CaptureTime;
+	double Latency = 0; // milliseconds from the capture to the end of processing
+	bool ConeFound = false;
+	ConeDetails Details{};
+
+	bool MultiCone = false;
+	vector<ConeDetails> Cones; // every cone, nearest first, only in multi cone mode
+};
+
+/**
+ * \brief Microseconds on the steady clock, which the local sinks and their receivers on the same machine share.
+ */
+inline int64_t SteadyMicroseconds(const time_point<steady_clock> time) {
+	return duration_cast<microseconds>(time.time_since_epoch()).count();
+}
+
+/**
+ * \brief Writes a reading into the first READING_SIZE values.
+ * \param captureTime The capture time of the reading in the time base of the sink.
+ * \param publishTime The time the reading is sent at in the time base of the sink.
+ */
+inline void EncodeReading(const ConeReading& reading, const int64_t captureTime, const int64_t publishTime, double* values) {
+
+	const ConeDetails& details = reading.Details;
+
+	values[READING_FRAME_ID] = (double)reading.FrameId;
+	values[READING_CAPTURE_TIME] = (double)captureTime;
+	values[READING_LATENCY] = reading.Latency;
+	values[READING_FOUND] = reading.ConeFound;
+	values[READING_CENTROID_X] = details.GetCentroidPosition().x;
+	values[READING_CENTROID_Y] = details.GetCentroidPosition().y;
+	values[READING_TIP_X] = details.GetTipPosition().x;
+	values[READING_TIP_Y] = details.GetTipPosition().y;
+	values[READING_CENTROID_CAMERA_X] = details.GetCentroidCameraPosition().x;
+	values[READING_CENTROID_CAMERA_Y] = details.GetCentroidCameraPosition().y;
+	values[READING_TIP_CAMERA_X] = details.GetTipCameraPosition().x;
+	values[READING_TIP_CAMERA_Y] = details.GetTipCameraPosition().y;
+	values[READING_ANGLE] = details.GetAngle() * 180l / PI;
+	values[READING_PUBLISH_TIME] = (double)publishTime;
+}
+
+/**
+ * \brief Writes a reading and up to PACKET_CONE_LIMIT of its cones into PACKET_SIZE values, timed on the steady clock.
+ */
+inline void EncodePacket(const ConeReading& reading, double* packet) {
+
+	const int coneCount = reading.MultiCone ? min((int)reading.Cones.size(), PACKET_CONE_LIMIT) : 0;
+
+	packet[PACKET_CONE_COUNT] = coneCount;
+
+	for (int i = 0; i < coneCount; i++) {
+		packet[PACKET_CONES + 3 * i] = reading.Cones[i].GetCentroidPosition().x;
+		packet[PACKET_CONES + 3 * i + 1] = reading.Cones[i].GetCentroidPosition().y;
+		packet[PACKET_CONES + 3 * i + 2] = reading.Cones[i].GetAngle() * 180l / PI;
+	}
+
+	EncodeReading(reading, SteadyMicroseconds(reading.CaptureTime), SteadyMicroseconds(steady_clock::now()), packet);
+}
+
+/**
+ * \brief Where the cone readings are published to. Only ever called from the publisher thread.
+ */
+class ResultSink {
+
+	public:
+
+		virtual ~ResultSink() = default;
+
+		/**
+		 * \brief False if the sink could not be set up, in which case publishing does nothing.
+		 */
+		virtual bool IsValid() const = 0;
+
+		virtual void Publish(const ConeReading& reading) = 0;
+
+};
\ No newline at end of file
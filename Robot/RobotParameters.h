@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include "../DetectionCore/Parameters.h"
+
+
+
+/**
+ * \brief The parameters of the robot, which are the defaults with the color masks tuned for the camera on the robot.
+ */
+inline Parameters RobotParameters() {
+
+	Parameters parameters = Parameters();
+
+	parameters.MiddleHueMin = 8;
+	parameters.MiddleHueMax = 30;
+	parameters.MiddleSaturationMin = 150;
+	parameters.MiddleSaturationMax = 255;
+	parameters.MiddleValueMin = 130;
+	parameters.MiddleValueMax = 255;
+
+	parameters.HighlightHueMin = 4;
+	parameters.HighlightHueMax = 30;
+	parameters.HighlightSaturationMin = 40;
+	parameters.HighlightSaturationMax = 255;
+	parameters.HighlightValueMin = 240;
+	parameters.HighlightValueMax = 255;
+
+	parameters.LowLightHueMin = 3;
+	parameters.LowLightHueMax = 31;
+	parameters.LowLightSaturationMin = 255;
+	parameters.LowLightSaturationMax = 255;
+	parameters.LowLightValueMin = 104;
+	parameters.LowLightValueMax = 255;
+
+	return parameters;
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+
+#include "../DetectionCore/ConeDetails.h"
+#include "../DetectionCore/ConeDetector.h"
+#include "../DetectionCore/Detection.h"
+#include "../DetectionCore/Parameters.h"
+#include "../DetectionCore/PipelineContext.h"
+
+#include "BoundedQueue.h"
+
+using namespace cv;
+using namespace std;
+using namespace std::chrono;
+
+
+
+/**
+ * \brief A frame travelling through the staged pipeline, with its own buffers so the stages can work on different frames at once.
+ */
+struct PipelineFrame {
+
+	Mat Image;
+	time_point<steady_clock> CaptureTime;
+	long long Sequence = 0;
+
+	PipelineContext Context; // only used when the whole image is preprocessed ahead of the rest of the detection
+	ConeDetails Details{}; // filtered if TemporalFilter is set, the nearest cone in multi cone mode
+	bool ConeFound = false;
+	vector<ConeDetails> Cones; // every cone found, nearest first, only in multi cone mode
+
+	long long DroppedFrameCount = 0; // dropped by the whole pipeline up to the time this frame was published
+
+	PipelineFrame(const Point2i cameraResolution, const PipelineTables& tables) : Context(cameraResolution, tables) {
+		Cones.reserve(16);
+	}
+};
+
+/**
+ * \brief Runs capture, preprocessing, the rest of the detection and publishing on one worker thread each, connected by bounded queues.
+ *  The stages overlap so the throughput is limited by the slowest stage instead of the sum of all of them. When a stage falls behind, the
+ *  queue in front of it drops its oldest frame, and the frame goes back to the pool. The detection runs through the same ConeDetector as
+ *  the serial pipeline, so the filter and every search mode behave the same. Region tracking and the coarse to fine search decide what to
+ *  preprocess while detecting, so with them the whole detection runs in the detection stage and only capture and publishing overlap it.
+ */
+class StagedPipeline {
+
+		VideoCapture& Capture;
+		const Parameters& PipelineParameters;
+		ConeDetector Detector; // its tables are shared by the contexts of every frame, the parameters do not change while the pipeline runs
+		function<void(const PipelineFrame&)> Publish;
+
+		vector<unique_ptr<PipelineFrame>> Frames;
+		BoundedQueue<PipelineFrame*> FreeFrames;
+		BoundedQueue<PipelineFrame*> CapturedFrames;
+		BoundedQueue<PipelineFrame*> PreProcessedFrames;
+		BoundedQueue<PipelineFrame*> DetectedFrames;
+
+		vector<thread> Workers;
+		atomic<bool> Running;
+		atomic<long long> FailedReadCount;
+
+		void Recycle(PipelineFrame* frame) {
+
+			PipelineFrame* unused = nullptr;
+			FreeFrames.Push(frame, unused);
+		}
+
+		void PushDroppingOldest(BoundedQueue<PipelineFrame*>& queue, PipelineFrame* frame) {
+
+			PipelineFrame* dropped = nullptr;
+
+			if (queue.Push(frame, dropped)) {
+				Recycle(dropped);
+			}
+		}
+
+		void CaptureStage() {
+
+			long long sequence = 0;
+			PipelineFrame* frame = nullptr;
+
+			while (Running.load(memory_order_relaxed) && FreeFrames.Pop(frame)) {
+
+				if (!Capture.read(frame->Image) || frame->Image.empty()) {
+					FailedReadCount++;
+					Recycle(frame);
+					this_thread::sleep_for(milliseconds(1));
+					continue;
+				}
+
+				frame->CaptureTime = steady_clock::now();
+				frame->Sequence = ++sequence;
+
+				PushDroppingOldest(CapturedFrames, frame);
+			}
+		}
+
+		void PreProcessStage() {
+
+			PipelineFrame* frame = nullptr;
+
+			while (CapturedFrames.Pop(frame)) {
+
+				if (PreProcessesWholeImage(PipelineParameters)) {
+					PreProcessImage(frame->Image, PipelineParameters, frame->Context);
+				}
+
+				PushDroppingOldest(PreProcessedFrames, frame);
+			}
+		}
+
+		void DetectionStage() {
+
+			PipelineFrame* frame = nullptr;
+
+			while (PreProcessedFrames.Pop(frame)) {
+
+				const DetectionResult& result = PreProcessesWholeImage(PipelineParameters) ?
+					Detector.ProcessPreProcessed(frame->Context, frame->CaptureTime) : Detector.Process(frame->Image, frame->CaptureTime);
+
+				frame->ConeFound = result.ConeFound;
+				frame->Details = result.Details;
+				frame->Cones = result.Cones;
+
+				PushDroppingOldest(DetectedFrames, frame);
+			}
+		}
+
+		void PublishStage() {
+
+			PipelineFrame* frame = nullptr;
+
+			while (DetectedFrames.Pop(frame)) {
+				frame->DroppedFrameCount = GetDroppedFrameCount();
+				Publish(*frame);
+				Recycle(frame);
+			}
+		}
+
+	public:
+
+		/**
+		 * \param capture An opened video capture. It must outlive the pipeline and must not be used by anything else while it runs.
+		 * \param parameters Read concurrently by the stages, so it must not change while the pipeline runs.
+		 * \param depth The number of frames each queue between two stages can hold before it starts dropping the oldest one.
+		 * \param publish Called on the publishing thread for every frame that made it through the pipeline, in capture order.
+		 */
+		StagedPipeline(VideoCapture& capture, const Parameters& parameters, const int depth, function<void(const PipelineFrame&)> publish) :
+			Capture(capture), PipelineParameters(parameters), Detector(parameters), Publish(move(publish)),
+			FreeFrames(3 * max(depth, 1) + 4), CapturedFrames(max(depth, 1)), PreProcessedFrames(max(depth, 1)), DetectedFrames(max(depth, 1)),
+			Running(false), FailedReadCount(0) {
+
+			// enough frames to fill every queue while each of the 4 stages holds one, so the capture stage never waits for a free frame
+			const int frameCount = 3 * max(depth, 1) + 4;
+
+			for (int i = 0; i < frameCount; i++) {
+				Frames.push_back(make_unique<PipelineFrame>(parameters.CameraResolution, Detector.GetTables()));
+				Recycle(Frames.back().get());
+			}
+		}
+
+		StagedPipeline(const StagedPipeline&) = delete;
+		StagedPipeline& operator=(const StagedPipeline&) = delete;
+
+		~StagedPipeline() {
+			Stop();
+		}
+
+		void Start() {
+
+			if (Running.exchange(true)) {
+				return;
+			}
+
+			Workers.emplace_back(&StagedPipeline::CaptureStage, this);
+			Workers.emplace_back(&StagedPipeline::PreProcessStage, this);
+			Workers.emplace_back(&StagedPipeline::DetectionStage, this);
+			Workers.emplace_back(&StagedPipeline::PublishStage, this);
+		}
+
+		/**
+		 * \brief Stops capturing, lets the frames already in the pipeline drain and waits for every worker to finish.
+		 */
+		void Stop() {
+
+			if (!Running.exchange(false)) {
+				return;
+			}
+
+			FreeFrames.Close();
+			Workers[0].join();
+
+			CapturedFrames.Close();
+			Workers[1].join();
+
+			PreProcessedFrames.Close();
+			Workers[2].join();
+
+			DetectedFrames.Close();
+			Workers[3].join();
+
+			Workers.clear();
+		}
+
+		/**
+		 * \brief The number of frames dropped by all queues because a stage fell behind.
+		 */
+		long long GetDroppedFrameCount() const {
+			return CapturedFrames.GetDroppedCount() + PreProcessedFrames.GetDroppedCount() + DetectedFrames.GetDroppedCount();
+		}
+
+		/**
+		 * \brief The number of reads that failed or returned an empty image.
+		 */
+		long long GetFailedReadCount() const {
+			return FailedReadCount;
+		}
+
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <atomic>
+
+using namespace std;
+
+
+
+/**
+ * \brief A lock-free single producer, single consumer slot that always hands the consumer the most recently published value. The
+ *  producer and the consumer each own one of the three buffers, and the third one is swapped between them atomically, so neither side
+ *  ever waits for the other. Values the consumer never picked up are overwritten and counted as dropped.
+ */
+template <typename T>
+class TripleBuffer {
+
+		// the low bits hold the index of the shared buffer, FreshBit is set when it holds a value the consumer has not picked up yet
+		static const int IndexMask = 3;
+		static const int FreshBit = 4;
+
+		T Buffers[3];
+		atomic<int> Shared;
+		int WriteIndex = 0;
+		int ReadIndex = 2;
+
+	public:
+
+		TripleBuffer() : Shared(1) {}
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		/**
+		 * \brief The buffer owned by the producer. Only call this from the producer thread.
+		 */
+		T& GetWriteBuffer() {
+			return Buffers[WriteIndex];
+		}
+
+		/**
+		 * \brief Hands the write buffer over to the consumer and gives the producer a new buffer to write into. Only call this from the
+		 *  producer thread.
+		 * \return True if the previously published value was never picked up by the consumer and has been dropped.
+		 */
+		bool Publish() {
+
+			const int previous = Shared.exchange(WriteIndex | FreshBit, memory_order_acq_rel);
+			WriteIndex = previous & IndexMask;
+
+			return (previous & FreshBit) != 0;
+		}
+
+		/**
+		 * \brief Picks up the newest published value if there is one, without blocking. Only call this from the consumer thread.
+		 * \return True if the read buffer now holds a value that has not been read before.
+		 */
+		bool Acquire() {
+
+			if ((Shared.load(memory_order_relaxed) & FreshBit) == 0) {
+				return false;
+			}
+
+			const int previous = Shared.exchange(ReadIndex, memory_order_acq_rel);
+			ReadIndex = previous & IndexMask;
+
+			return true;
+		}
+
+		/**
+		 * \brief The buffer owned by the consumer, which holds the value picked up by the last successful Acquire. Only call this from
+		 *  the consumer thread.
+		 */
+		T& GetReadBuffer() {
+			return Buffers[ReadIndex];
+		}
+
+};
\ No newline at end of file
@@ -1,28 +0,0 @@
-﻿#pragma once
-
-#include <opencv2/imgproc.hpp>
-
-using namespace std;
-using namespace cv;
-
-
-
-inline void SquareDilate(InputArray source, OutputArray destination, int kernelSize) {
-
-	if (kernelSize % 2 == 0) {
-		kernelSize++;
-	}
-
-	const Mat dilationKernel = getStructuringElement(MORPH_RECT, Size(kernelSize, kernelSize));
-	dilate(source, destination, dilationKernel);
-}
-
-inline void SquareErode(InputArray source, OutputArray destination, int kernelSize) {
-
-	if (kernelSize % 2 == 0) {
-		kernelSize++;
-	}
-
-	const Mat erosionKernel = getStructuringElement(MORPH_RECT, Size(kernelSize, kernelSize));
-	erode(source, destination, erosionKernel);
-}
\ No newline at end of file